@@ -0,0 +1,213 @@
+/*
+ * Micro-benchmarks for the hot paths of gapsdecor.
+ *
+ * The theme, layout and buttons are built against the stubbed Wayfire API in
+ * stubs/, so the benchmark runs without a compositor or a GPU. Drawing with
+ * GL is a no-op: only the CPU side is measured. What drawing costs, with GL
+ * emulated by llvmpipe, is reported as decoration_ms by gapsdecor-replay.py.
+ *
+ * Every benchmark prints a single JSON object per line, so results can be
+ * compared between runs by scripts:
+ *
+ *   {"name": "...", "iterations": N, "ns_per_op": X}
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "deco-layout.hpp"
+#include "deco-text.hpp"
+#include "deco-theme.hpp"
+
+namespace {
+/** Run @op until at least @min_time has passed and report the cost per call */
+void run_benchmark(const std::string &name, const std::function<void()> &op,
+                   std::chrono::milliseconds min_time =
+                       std::chrono::milliseconds(200)) {
+  using clock = std::chrono::steady_clock;
+
+  /* Warm up caches, font loading, etc. */
+  op();
+
+  size_t iterations = 0;
+  auto start = clock::now();
+  auto elapsed = clock::duration::zero();
+  while (elapsed < min_time) {
+    op();
+    ++iterations;
+    elapsed = clock::now() - start;
+  }
+
+  double ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  std::printf("{\"name\": \"%s\", \"iterations\": %zu, \"ns_per_op\": %.1f}\n",
+              name.c_str(), iterations, ns / iterations);
+}
+
+/**
+ * The title rendering before pango state was cached: every call parses the
+ * font and creates a new layout.
+ */
+cairo_surface_t *render_text_uncached(const std::string &text,
+                                      const std::string &font, int width,
+                                      int height) {
+  auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+  auto cr = cairo_create(surface);
+
+  auto font_desc = pango_font_description_from_string(font.c_str());
+  pango_font_description_set_absolute_size(font_desc,
+                                           height * 0.8 * PANGO_SCALE);
+
+  auto layout = pango_cairo_create_layout(cr);
+  pango_layout_set_font_description(layout, font_desc);
+  pango_layout_set_text(layout, text.c_str(), text.size());
+  cairo_set_source_rgba(cr, 1, 1, 1, 1);
+  pango_cairo_show_layout(cr, layout);
+  pango_font_description_free(font_desc);
+  g_object_unref(layout);
+  cairo_destroy(cr);
+
+  return surface;
+}
+
+const std::vector<std::string> titles = {
+    "Terminal",
+    "vim ~/src/wayfire-plugins/plugins/gapsdecor/src/deco-subsurface.cpp",
+    "Mozilla Firefox - Performance analysis of window decorations in a "
+    "Wayland compositor written in C++ with cairo and pango",
+};
+
+const std::vector<int> heights = {30, 60};
+
+const std::vector<double> hover_states = {-0.7, 0.0, 0.5, 1.0};
+
+/* Keeps results alive, so that the compiler cannot drop the work */
+volatile size_t sink;
+
+/** The defaults from metadata/gapsdecor.xml */
+wf::decor::theme_options_t get_default_options() {
+  return wf::decor::theme_options_t{
+      .font = "sans-serif",
+      .title_height = 30,
+      .border_size = 4,
+      .active_color = {0x22 / 255.0, 0x22 / 255.0, 0x22 / 255.0, 0xAA / 255.0},
+      .inactive_color = {0x33 / 255.0, 0x33 / 255.0, 0x33 / 255.0,
+                         0xDD / 255.0},
+      .resize_stable_title = true,
+      .shader_buttons = true,
+      .composite_titlebar = false,
+      .button_order = "minimize maximize close",
+  };
+}
+
+void bench_text(const std::string &font) {
+  wf::decor::text_renderer_t renderer;
+  for (int height : heights) {
+    for (size_t i = 0; i < titles.size(); i++) {
+      auto suffix = "/len=" + std::to_string(titles[i].size()) +
+                    "/height=" + std::to_string(height);
+
+      run_benchmark("render_text_uncached" + suffix, [&]() {
+        cairo_surface_destroy(
+            render_text_uncached(titles[i], font, 800, height));
+      });
+
+      run_benchmark("render_text" + suffix, [&]() {
+        cairo_surface_destroy(wf::decor::gapsdecor_theme_t::render_text(
+            titles[i], font, {1, 1, 1, 1}, 800, height));
+      });
+
+      run_benchmark("render_text_natural" + suffix, [&]() {
+        cairo_surface_destroy(renderer.render(
+            titles[i], font, {1, 1, 1, 1},
+            wf::decor::text_renderer_t::NATURAL_WIDTH, height));
+      });
+    }
+  }
+}
+
+void bench_buttons(const wf::decor::gapsdecor_theme_t &theme) {
+  const std::pair<wf::decor::button_type_t, std::string> types[] = {
+      {wf::decor::BUTTON_CLOSE, "close"},
+      {wf::decor::BUTTON_TOGGLE_MAXIMIZE, "maximize"},
+      {wf::decor::BUTTON_MINIMIZE, "minimize"},
+  };
+
+  for (int height : heights) {
+    for (auto &[type, type_name] : types) {
+      for (double hover : hover_states) {
+        wf::decor::gapsdecor_theme_t::button_state_t state;
+        state.width = height * 0.7;
+        state.height = height * 0.7;
+        state.border = 1.0;
+        state.hover_progress = hover;
+
+        char hover_str[16];
+        std::snprintf(hover_str, sizeof(hover_str), "%.2f", hover);
+        auto name = "get_button_surface/type=" + type_name +
+                    "/hover=" + hover_str +
+                    "/size=" + std::to_string((int)state.width);
+        run_benchmark(name, [&]() {
+          cairo_surface_destroy(theme.get_button_surface(type, state));
+        });
+      }
+    }
+  }
+}
+
+void bench_layout(wf::decor::gapsdecor_theme_t &theme) {
+  wf::decor::gapsdecor_layout_t layout{theme, [](wlr_box) {}};
+  layout.resize(800, 600);
+
+  bool toggle = false;
+  run_benchmark("layout_resize", [&]() {
+    toggle = !toggle;
+    layout.resize(toggle ? 801 : 800, toggle ? 601 : 600);
+  });
+
+  layout.resize(800, 600);
+
+  /* A pointer crossing the titlebar, buttons and every border */
+  std::vector<wf::point_t> path;
+  for (int x = 0; x < 800; x += 7) {
+    path.push_back({x, 20});
+  }
+
+  for (int y = 0; y < 600; y += 7) {
+    path.push_back({2, y});
+    path.push_back({797, y});
+  }
+
+  for (int x = 0; x < 800; x += 7) {
+    path.push_back({x, 598});
+  }
+
+  size_t next = 0;
+  run_benchmark("handle_motion", [&]() {
+    auto &point = path[next];
+    next = (next + 1) % path.size();
+    sink = layout.handle_motion(point.x, point.y).action;
+  });
+
+  run_benchmark("calculate_region", [&]() {
+    sink = layout.calculate_region().empty();
+  });
+}
+} // namespace
+
+int main() {
+  wf::decor::gapsdecor_theme_t theme{get_default_options()};
+  theme.set_buttons(wf::decor::button_type_t(wf::decor::BUTTON_MINIMIZE |
+                                             wf::decor::BUTTON_TOGGLE_MAXIMIZE |
+                                             wf::decor::BUTTON_CLOSE));
+
+  bench_text(theme.get_font());
+  bench_buttons(theme);
+  bench_layout(theme);
+
+  return 0;
+}
@@ -0,0 +1,418 @@
+#!/usr/bin/env python3
+"""
+Replay scripted pointer sequences against decorated windows in a headless
+Wayfire, and report what each scenario cost.
+
+Wayfire runs on the headless wlroots backend with Mesa's llvmpipe software
+renderer, so no GPU is needed and results are comparable between machines.
+Input is injected with the stipc plugin, windows are found with ipc-rules and
+the cost is read from gapsdecor/stats before and after each scenario.
+
+Scenarios:
+  move    drag each window by its titlebar (GAPSDECOR_ACTION_MOVE)
+  resize  drag the bottom-right corner of each window (GAPSDECOR_ACTION_RESIZE)
+  hover   sweep the pointer back and forth over the window buttons
+  reload  unload and load gapsdecor with all windows open, by editing the
+          config file which Wayfire watches
+  map     open more windows, once decorated and once with decorations
+          disabled through gapsdecor/ignore_views
+
+Every scenario prints a single JSON object per line:
+
+  {"name": "move", "frames": N, "frame_ms": X, "frame_p99_ms": X,
+   "decoration_ms": X, "texture_uploads": N, "bytes_uploaded": N, ...}
+
+  {"name": "reload", "views": N, "load_ms": X, "unload_ms": X}
+
+  {"name": "map", "decorated": true, "maps": N, "map_to_first_frame_ms": X,
+   "map_to_first_frame_p99_ms": X, "first_frames_without_title": N}
+
+Example, with gapsdecor built but not installed:
+
+  ./gapsdecor-replay.py --clients 8 \\
+      --plugin-path ../build/src --metadata-path ../metadata
+
+Loading and unloading the plugin with 500 windows open:
+
+  ./gapsdecor-replay.py --clients 500 --scenarios reload
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+# Must match the defaults of metadata/gapsdecor.xml
+BORDER_SIZE = 4
+TITLE_HEIGHT = 30
+
+PLUGINS = "ipc ipc-rules stipc"
+
+CONFIG = """
+[core]
+plugins = {plugins}
+preferred_decoration_mode = server
+close_top_view = none
+
+[gapsdecor]
+border_size = {border}
+title_height = {title}
+ignore_views = {ignore_views}
+"""
+
+
+class WayfireSocket:
+    """Wayfire's IPC protocol: a 32-bit length followed by JSON."""
+
+    def __init__(self, path):
+        self.client = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.client.connect(path)
+
+    def read_exact(self, n):
+        data = b""
+        while len(data) < n:
+            chunk = self.client.recv(n - len(data))
+            if not chunk:
+                raise RuntimeError("Wayfire closed the IPC socket")
+            data += chunk
+        return data
+
+    def call(self, method, data=None):
+        message = json.dumps({"method": method, "data": data or {}}).encode()
+        self.client.sendall(struct.pack("<I", len(message)) + message)
+        length = struct.unpack("<I", self.read_exact(4))[0]
+        response = json.loads(self.read_exact(length))
+        if isinstance(response, dict) and "error" in response:
+            raise RuntimeError("{}: {}".format(method, response["error"]))
+        return response
+
+
+class Compositor:
+    def __init__(self, args, workdir):
+        self.args = args
+        config = os.path.join(workdir, "wayfire.ini")
+        self.config_path = config
+        self.write_config(gapsdecor=True)
+
+        self.socket_path = os.path.join(workdir, "wayfire.socket")
+        env = dict(os.environ)
+        env.update({
+            "WAYFIRE_SOCKET": self.socket_path,
+            "WLR_BACKENDS": "headless",
+            "WLR_HEADLESS_OUTPUTS": "1",
+            "WLR_LIBINPUT_NO_DEVICES": "1",
+            # Software rendering, so that no GPU is needed
+            "WLR_RENDERER": "gles2",
+            "WLR_RENDERER_ALLOW_SOFTWARE": "1",
+            "LIBGL_ALWAYS_SOFTWARE": "1",
+            "GALLIUM_DRIVER": "llvmpipe",
+        })
+        env.setdefault("XDG_RUNTIME_DIR", workdir)
+        env.pop("WAYLAND_DISPLAY", None)
+        env.pop("DISPLAY", None)
+
+        if args.plugin_path:
+            env["WAYFIRE_PLUGIN_PATH"] = os.path.abspath(args.plugin_path)
+        if args.metadata_path:
+            env["WAYFIRE_PLUGIN_XML_PATH"] = os.path.abspath(args.metadata_path)
+
+        self.log = open(os.path.join(workdir, "wayfire.log"), "w")
+        self.process = subprocess.Popen([args.wayfire, "-c", config], env=env,
+                                        stdout=self.log, stderr=self.log)
+        self.ipc = self.connect()
+
+    def connect(self):
+        deadline = time.monotonic() + 10
+        while time.monotonic() < deadline:
+            if self.process.poll() is not None:
+                raise RuntimeError("Wayfire exited, see " + self.log.name)
+            if os.path.exists(self.socket_path):
+                try:
+                    ipc = WayfireSocket(self.socket_path)
+                    ipc.call("stipc/ping")
+                    return ipc
+                except (ConnectionRefusedError, RuntimeError):
+                    pass
+            time.sleep(0.1)
+        raise RuntimeError("Timed out waiting for Wayfire's IPC socket")
+
+    def write_config(self, gapsdecor, ignore_views="none"):
+        plugins = PLUGINS + (" gapsdecor" if gapsdecor else "")
+        with open(self.config_path, "w") as f:
+            f.write(CONFIG.format(plugins=plugins, border=BORDER_SIZE,
+                                  title=TITLE_HEIGHT,
+                                  ignore_views=ignore_views))
+
+    def read_log(self):
+        with open(self.log.name) as f:
+            return f.read()
+
+    def wait_for_log(self, pattern, count):
+        """Wait until @pattern occurred @count times in the log"""
+        deadline = time.monotonic() + 30
+        while time.monotonic() < deadline:
+            matches = pattern.findall(self.read_log())
+            if len(matches) >= count:
+                return matches[count - 1]
+            time.sleep(0.1)
+        raise RuntimeError("Timed out waiting for " + pattern.pattern)
+
+    def stop(self):
+        self.process.terminate()
+        try:
+            self.process.wait(5)
+        except subprocess.TimeoutExpired:
+            self.process.kill()
+        self.log.close()
+
+    def views(self):
+        return [v for v in self.ipc.call("window-rules/list-views")
+                if v.get("mapped") and v.get("role") == "toplevel"]
+
+    def spawn_clients(self, count, command):
+        expected = len(self.views()) + count
+        for _ in range(count):
+            self.ipc.call("stipc/run", {"cmd": command})
+
+        deadline = time.monotonic() + 30
+        while len(self.views()) < expected:
+            if time.monotonic() > deadline:
+                raise RuntimeError("Only {} of {} clients mapped".format(
+                    len(self.views()), expected))
+            time.sleep(0.2)
+
+    def move_cursor(self, x, y):
+        self.ipc.call("stipc/move_cursor", {"x": x, "y": y})
+
+    def button(self, mode):
+        self.ipc.call("stipc/feed_button", {"combo": "BTN_LEFT", "mode": mode})
+
+    def stats(self):
+        return self.ipc.call("gapsdecor/stats")
+
+
+def drag(compositor, start, delta, steps, frame_time):
+    """Press at @start, move by @delta in @steps, then release"""
+    x, y = start
+    compositor.move_cursor(x, y)
+    compositor.button("press")
+    for i in range(1, steps + 1):
+        compositor.move_cursor(x + delta[0] * i / steps,
+                               y + delta[1] * i / steps)
+        time.sleep(frame_time)
+    compositor.button("release")
+    time.sleep(frame_time)
+
+
+def scenario_move(compositor, view, args):
+    g = view["geometry"]
+    titlebar = (g["x"] + BORDER_SIZE + 20,
+                g["y"] + BORDER_SIZE + TITLE_HEIGHT // 2)
+    drag(compositor, titlebar, (args.distance, args.distance // 2),
+         args.steps, args.frame_time)
+
+
+def scenario_resize(compositor, view, args):
+    g = view["geometry"]
+    corner = (g["x"] + g["width"] - 1, g["y"] + g["height"] - 1)
+    drag(compositor, corner, (args.distance, args.distance), args.steps,
+         args.frame_time)
+    # Shrink back, so that the windows do not grow with each repetition
+    corner = (corner[0] + args.distance, corner[1] + args.distance)
+    drag(compositor, corner, (-args.distance, -args.distance), args.steps,
+         args.frame_time)
+
+
+def scenario_hover(compositor, view, args):
+    g = view["geometry"]
+    y = g["y"] + BORDER_SIZE + TITLE_HEIGHT // 2
+    right = g["x"] + g["width"] - BORDER_SIZE
+    left = right - 4 * TITLE_HEIGHT
+    for i in range(args.steps):
+        # Back and forth over the buttons, so that hover animations run
+        phase = i % 20
+        t = phase / 10 if phase < 10 else (20 - phase) / 10
+        compositor.move_cursor(left + (right - left) * t, y)
+        time.sleep(args.frame_time)
+
+
+SCENARIOS = {
+    "move": scenario_move,
+    "resize": scenario_resize,
+    "hover": scenario_hover,
+}
+
+# Logged by the plugin in init() and fini()
+LOAD_LOG = re.compile(r"gapsdecor: loaded with (\d+) views in ([\d.e+-]+) ms")
+UNLOAD_LOG = re.compile(
+    r"gapsdecor: unloaded with (\d+) views in ([\d.e+-]+) ms")
+
+
+def scenario_map(compositor, args):
+    """Open windows with and without decorations, and report how long they
+    took to appear"""
+    for decorated in (True, False):
+        compositor.write_config(gapsdecor=True,
+                                ignore_views="none" if decorated else "all")
+        # Give Wayfire time to notice the new config
+        time.sleep(1)
+
+        before = compositor.stats()
+        for _ in range(args.repeat):
+            compositor.spawn_clients(args.clients, args.client)
+        # Let the last windows be drawn
+        time.sleep(0.5)
+        after = compositor.stats()
+
+        maps = delta(before, after, "timings", "map_to_first_frame", "count")
+        total = delta(before, after, "timings", "map_to_first_frame",
+                      "total_ms")
+        result = {
+            "name": "map",
+            "decorated": decorated,
+            "maps": maps,
+            "map_to_first_frame_ms": round(total / maps, 4) if maps else 0.0,
+            "map_to_first_frame_p99_ms":
+                after["timings"]["map_to_first_frame"]["p99_ms"],
+            "first_frames_without_title":
+                delta(before, after, "totals", "first_frames_without_title"),
+        }
+        print(json.dumps(result), flush=True)
+
+    compositor.write_config(gapsdecor=True)
+
+
+def scenario_reload(compositor, args):
+    """Unload and load gapsdecor, and report the time both took"""
+    loads = len(LOAD_LOG.findall(compositor.read_log()))
+    unloads = len(UNLOAD_LOG.findall(compositor.read_log()))
+    load_ms = []
+    unload_ms = []
+    views = 0
+    for i in range(args.repeat):
+        compositor.write_config(gapsdecor=False)
+        views, ms = compositor.wait_for_log(UNLOAD_LOG, unloads + i + 1)
+        unload_ms.append(float(ms))
+
+        compositor.write_config(gapsdecor=True)
+        views, ms = compositor.wait_for_log(LOAD_LOG, loads + i + 1)
+        load_ms.append(float(ms))
+
+    result = {
+        "name": "reload",
+        "views": int(views),
+        "load_ms": round(sum(load_ms) / len(load_ms), 4),
+        "unload_ms": round(sum(unload_ms) / len(unload_ms), 4),
+    }
+    print(json.dumps(result), flush=True)
+
+
+# Scenarios which run once, instead of once per window
+GLOBAL_SCENARIOS = {
+    "map": scenario_map,
+    "reload": scenario_reload,
+}
+
+
+def delta(before, after, *path):
+    for key in path:
+        before = before[key]
+        after = after[key]
+    return after - before
+
+
+def report(name, before, after):
+    frames = delta(before, after, "timings", "frame", "count")
+    frame_ms = delta(before, after, "timings", "frame", "total_ms")
+    deco_ms = delta(before, after, "timings", "render_scissor_box", "total_ms")
+    text_ms = delta(before, after, "timings", "render_text", "total_ms")
+    per_frame = (lambda v: v / frames) if frames else (lambda v: 0.0)
+
+    result = {
+        "name": name,
+        "frames": frames,
+        "frame_ms": round(per_frame(frame_ms), 4),
+        # The percentile covers the most recent frames, see timing_t
+        "frame_p99_ms": after["timings"]["frame"]["p99_ms"],
+        "decoration_ms": round(per_frame(deco_ms), 4),
+        "decoration_p99_ms":
+            after["timings"]["render_scissor_box"]["p99_ms"],
+        "render_text_ms": round(text_ms, 4),
+        "title_rasterizations":
+            delta(before, after, "totals", "title_rasterizations"),
+        "texture_uploads": delta(before, after, "totals", "texture_uploads"),
+        "bytes_uploaded": delta(before, after, "totals", "bytes_uploaded"),
+        "transactions_scheduled":
+            delta(before, after, "totals", "transactions_scheduled"),
+        "transactions_skipped":
+            delta(before, after, "totals", "transactions_skipped"),
+    }
+    print(json.dumps(result), flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument("--wayfire", default="wayfire",
+                        help="the wayfire binary")
+    parser.add_argument("--plugin-path",
+                        help="directory containing libgapsdecor.so")
+    parser.add_argument("--metadata-path",
+                        help="directory containing gapsdecor.xml")
+    parser.add_argument("--clients", type=int, default=4,
+                        help="number of test clients to start")
+    parser.add_argument("--client", default="weston-simple-shm",
+                        help="command starting one test client")
+    parser.add_argument("--scenarios", default="move,resize,hover",
+                        help="comma-separated list of: " +
+                        ", ".join(list(SCENARIOS) + list(GLOBAL_SCENARIOS)))
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="how many times each scenario is replayed")
+    parser.add_argument("--steps", type=int, default=60,
+                        help="pointer events per drag or sweep")
+    parser.add_argument("--distance", type=int, default=200,
+                        help="distance of each drag, in pixels")
+    parser.add_argument("--frame-time", type=float, default=1 / 60,
+                        help="delay between pointer events, in seconds")
+    args = parser.parse_args()
+
+    scenarios = args.scenarios.split(",")
+    for name in scenarios:
+        if name not in SCENARIOS and name not in GLOBAL_SCENARIOS:
+            parser.error("unknown scenario " + name)
+
+    if not shutil.which(args.wayfire):
+        parser.error("cannot find " + args.wayfire)
+
+    with tempfile.TemporaryDirectory(prefix="gapsdecor-replay-") as workdir:
+        compositor = Compositor(args, workdir)
+        try:
+            compositor.spawn_clients(args.clients, args.client)
+            for name in scenarios:
+                if name in GLOBAL_SCENARIOS:
+                    GLOBAL_SCENARIOS[name](compositor, args)
+                    continue
+
+                before = compositor.stats()
+                for _ in range(args.repeat):
+                    for view in compositor.views():
+                        SCENARIOS[name](compositor, view, args)
+                report(name, before, compositor.stats())
+        except RuntimeError as e:
+            print("gapsdecor-replay: {}".format(e), file=sys.stderr)
+            return 1
+        finally:
+            compositor.stop()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,20 @@
+/*
+ * Definitions for the stubbed Wayfire API in stubs/.
+ */
+
+#include <chrono>
+
+#include <wayfire/core.hpp>
+
+namespace wf {
+uint32_t get_current_time() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+compositor_core_t &get_core() {
+  static compositor_core_t core;
+  return core;
+}
+} // namespace wf
@@ -0,0 +1,12 @@
+#pragma once
+
+/* Stub: wf::color_t from wf-config */
+namespace wf {
+struct color_t {
+  double r, g, b, a;
+
+  bool operator==(const color_t &other) const {
+    return r == other.r && g == other.g && b == other.b && a == other.a;
+  }
+};
+} // namespace wf
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <wayfire/util.hpp>
+
+/* Stub: the parts of wf::compositor_core_t used by gapsdecor's layout */
+namespace wf {
+class compositor_core_t {
+public:
+  void set_cursor(std::string name) { ++cursor_changes; }
+
+  /* Number of set_cursor() calls, to check that the benchmark is sane */
+  uint64_t cursor_changes = 0;
+};
+
+compositor_core_t &get_core();
+} // namespace wf
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <wayfire/nonstd/wlroots.hpp>
+
+/* Stub: the geometry types of wayfire/geometry.hpp */
+namespace wf {
+struct point_t {
+  int x, y;
+};
+
+struct pointf_t {
+  double x, y;
+};
+
+struct dimensions_t {
+  int width;
+  int height;
+};
+
+using geometry_t = wlr_box;
+
+inline point_t operator+(const point_t &a, const point_t &b) {
+  return {a.x + b.x, a.y + b.y};
+}
+
+inline geometry_t operator+(const geometry_t &a, const point_t &b) {
+  return {a.x + b.x, a.y + b.y, a.width, a.height};
+}
+
+inline bool operator==(const geometry_t &a, const geometry_t &b) {
+  return a.x == b.x && a.y == b.y && a.width == b.width &&
+         a.height == b.height;
+}
+
+inline bool operator!=(const geometry_t &a, const geometry_t &b) {
+  return !(a == b);
+}
+
+/** @return Whether the two boxes intersect */
+inline bool operator&(const geometry_t &a, const geometry_t &b) {
+  return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height &&
+         b.y < a.y + a.height;
+}
+} // namespace wf
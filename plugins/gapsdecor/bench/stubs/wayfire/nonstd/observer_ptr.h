@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+/* Stub: a minimal nonstd::observer_ptr */
+namespace nonstd {
+template <class T> class observer_ptr {
+public:
+  observer_ptr() = default;
+  observer_ptr(std::nullptr_t) {}
+  explicit observer_ptr(T *ptr) : ptr(ptr) {}
+
+  T *get() const { return ptr; }
+  T *operator->() const { return ptr; }
+  T &operator*() const { return *ptr; }
+  explicit operator bool() const { return ptr != nullptr; }
+
+  bool operator==(const observer_ptr &other) const { return ptr == other.ptr; }
+  bool operator!=(const observer_ptr &other) const { return ptr != other.ptr; }
+
+private:
+  T *ptr = nullptr;
+};
+
+template <class T> observer_ptr<T> make_observer(T *ptr) {
+  return observer_ptr<T>(ptr);
+}
+} // namespace nonstd
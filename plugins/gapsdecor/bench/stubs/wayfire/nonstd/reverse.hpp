@@ -0,0 +1,14 @@
+#pragma once
+
+/* Stub: iterate a container backwards in a range-based for loop */
+namespace wf {
+template <class T> struct reverse_wrapper_t {
+  T &container;
+  auto begin() { return container.rbegin(); }
+  auto end() { return container.rend(); }
+};
+
+template <class T> reverse_wrapper_t<T> reverse(T &container) {
+  return {container};
+}
+} // namespace wf
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "wlroots.hpp"
+
+/* Same names as wlr_xcursor_get_resize_name() in wlroots */
+inline const char *wlr_xcursor_get_resize_name(enum wlr_edges edges) {
+  if (edges & WLR_EDGE_TOP) {
+    if (edges & WLR_EDGE_RIGHT) {
+      return "ne-resize";
+    } else if (edges & WLR_EDGE_LEFT) {
+      return "nw-resize";
+    }
+
+    return "n-resize";
+  } else if (edges & WLR_EDGE_BOTTOM) {
+    if (edges & WLR_EDGE_RIGHT) {
+      return "se-resize";
+    } else if (edges & WLR_EDGE_LEFT) {
+      return "sw-resize";
+    }
+
+    return "s-resize";
+  } else if (edges & WLR_EDGE_RIGHT) {
+    return "e-resize";
+  } else if (edges & WLR_EDGE_LEFT) {
+    return "w-resize";
+  }
+
+  return "se-resize";
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+/* Stub: the parts of wlroots used by gapsdecor's theme and layout */
+
+struct wlr_box {
+  int x, y, width, height;
+};
+
+enum wlr_edges {
+  WLR_EDGE_NONE = 0,
+  WLR_EDGE_TOP = 1,
+  WLR_EDGE_BOTTOM = 2,
+  WLR_EDGE_LEFT = 4,
+  WLR_EDGE_RIGHT = 8,
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <wayfire/config/types.hpp>
+#include <wayfire/geometry.hpp>
+
+/* Stub: nothing is drawn, all GL entry points are no-ops */
+typedef unsigned int GLuint;
+typedef float GLfloat;
+
+namespace glm {
+struct mat4 {};
+} // namespace glm
+
+namespace wf {
+struct render_target_t {
+  wf::geometry_t geometry = {0, 0, 0, 0};
+  float scale = 1.0;
+
+  glm::mat4 get_orthographic_projection() const { return {}; }
+  void logic_scissor(wlr_box) const {}
+};
+} // namespace wf
+
+namespace OpenGL {
+class program_t {
+public:
+  void free_resources() {}
+};
+
+inline void render_begin() {}
+inline void render_begin(const wf::render_target_t &) {}
+inline void render_end() {}
+inline void render_rectangle(wf::geometry_t, wf::color_t, glm::mat4) {}
+} // namespace OpenGL
@@ -0,0 +1,20 @@
+#pragma once
+
+/* Stub: a single instance of each type, shared by all references */
+namespace wf {
+namespace shared_data {
+template <class T> class ref_ptr_t {
+public:
+  ref_ptr_t() {
+    static T instance;
+    ptr = &instance;
+  }
+
+  T *get() { return ptr; }
+  T *operator->() { return ptr; }
+
+private:
+  T *ptr;
+};
+} // namespace shared_data
+} // namespace wf
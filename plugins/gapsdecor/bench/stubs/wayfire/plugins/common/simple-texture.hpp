@@ -0,0 +1,14 @@
+#pragma once
+
+#include <wayfire/opengl.hpp>
+
+/* Stub: a texture which is never allocated */
+namespace wf {
+struct simple_texture_t {
+  GLuint tex = (GLuint)-1;
+  int width = 0;
+  int height = 0;
+
+  void release() {}
+};
+} // namespace wf
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <pixman.h>
+#include <wayfire/geometry.hpp>
+
+/* Stub: wf::region_t on top of pixman, like the real one */
+namespace wf {
+class region_t {
+public:
+  region_t() { pixman_region32_init(&region); }
+  region_t(const region_t &other) {
+    pixman_region32_init(&region);
+    pixman_region32_copy(&region, &other.region);
+  }
+
+  region_t &operator=(const region_t &other) {
+    pixman_region32_copy(&region, &other.region);
+    return *this;
+  }
+
+  ~region_t() { pixman_region32_fini(&region); }
+
+  region_t &operator|=(const wlr_box &box) {
+    pixman_region32_union_rect(&region, &region, box.x, box.y, box.width,
+                               box.height);
+    return *this;
+  }
+
+  bool empty() const { return !pixman_region32_not_empty(&region); }
+  void clear() { pixman_region32_clear(&region); }
+
+  const pixman_box32_t *begin() const {
+    int n;
+    return pixman_region32_rectangles(&region, &n);
+  }
+
+  const pixman_box32_t *end() const {
+    int n;
+    auto boxes = pixman_region32_rectangles(&region, &n);
+    return boxes + n;
+  }
+
+private:
+  /* pixman takes non-const pointers even for queries */
+  mutable pixman_region32_t region;
+};
+} // namespace wf
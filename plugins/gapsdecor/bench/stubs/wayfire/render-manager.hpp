@@ -0,0 +1,3 @@
+#pragma once
+
+#include <wayfire/opengl.hpp>
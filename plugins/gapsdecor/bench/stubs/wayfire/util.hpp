@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <wayfire/geometry.hpp>
+#include <wayfire/nonstd/observer_ptr.h>
+
+/*
+ * Stub: there is no event loop in the benchmark. Timers never fire and idle
+ * calls are dropped, which leaves just the cost of scheduling them.
+ */
+namespace wf {
+uint32_t get_current_time();
+
+template <bool repeatable> class wl_timer {
+public:
+  template <class Callback> void set_timeout(uint32_t, Callback) {}
+  bool is_connected() const { return false; }
+  void disconnect() {}
+};
+
+class wl_idle_call {
+public:
+  void run_once(std::function<void()>) {}
+  bool is_connected() const { return false; }
+  void disconnect() {}
+};
+} // namespace wf
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+
+/* Stub: animations jump to their end value immediately */
+namespace wf {
+template <class T> struct stub_option_t {
+  T value;
+};
+
+template <class T> std::shared_ptr<stub_option_t<T>> create_option(T value) {
+  return std::make_shared<stub_option_t<T>>(stub_option_t<T>{value});
+}
+
+namespace animation {
+class simple_animation_t {
+public:
+  simple_animation_t(std::shared_ptr<stub_option_t<int>> length) {}
+
+  void animate(double start, double end) { value = end; }
+  void animate(double end) { value = end; }
+  bool running() const { return false; }
+  operator double() const { return value; }
+
+private:
+  double value = 0;
+};
+} // namespace animation
+} // namespace wf
@@ -0,0 +1,163 @@
+#include "deco-button-atlas.hpp"
+#include "deco-texture.hpp"
+#include "deco-theme.hpp"
+#include <algorithm>
+#include <cmath>
+#include <wayfire/debug.hpp>
+
+namespace wf {
+namespace decor {
+static int get_strip_index(button_type_t type) {
+  switch (type) {
+  case BUTTON_CLOSE:
+    return 0;
+
+  case BUTTON_TOGGLE_MAXIMIZE:
+    return 1;
+
+  case BUTTON_MINIMIZE:
+    return 2;
+  }
+
+  return 0;
+}
+
+static const button_type_t strip_types[] = {
+    BUTTON_CLOSE,
+    BUTTON_TOGGLE_MAXIMIZE,
+    BUTTON_MINIMIZE,
+};
+
+/** @return The state of the button drawn in the given cell */
+static gapsdecor_theme_t::button_state_t get_cell_state(int size, double scale,
+                                                        int cell) {
+  return gapsdecor_theme_t::button_state_t{
+      .width = 1.0 * size,
+      .height = 1.0 * size,
+      .border = scale,
+      .hover_progress = (cell - button_atlas_t::HOVER_STEPS) /
+                        (double)button_atlas_t::HOVER_STEPS,
+  };
+}
+
+/** @return The key of the strips for the theme's titlebar height at @scale */
+static std::pair<int, double> get_strip_key(const gapsdecor_theme_t &theme,
+                                            double scale) {
+  return {theme.get_title_height(), scale};
+}
+
+void button_atlas_t::build_strips(strip_set_t &set,
+                                  const gapsdecor_theme_t &theme,
+                                  double scale) {
+  GLint max_texture_size = 0;
+  GL_CALL(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size));
+
+  /**
+   * Cells are rendered at the full titlebar height and scaled down to the
+   * button size when drawn, which keeps them crisp. Cells larger than a
+   * texture are scaled up instead.
+   */
+  const int size =
+      std::clamp((int)std::round(theme.get_title_height() * scale), 1,
+                 std::max(1, (int)max_texture_size));
+  set.bytes = 0;
+  set.cell_size = size;
+  set.columns = std::clamp((int)max_texture_size / size, 1, HOVER_CELLS);
+  set.rows = (HOVER_CELLS + set.columns - 1) / set.columns;
+  if (set.rows > 1) {
+    LOGD("gapsdecor: button cells of ", size, " pixels wrap to ", set.rows,
+         " rows to fit the maximum texture size");
+  }
+
+  for (auto type : strip_types) {
+    auto strip = cairo_image_surface_create(
+        CAIRO_FORMAT_ARGB32, size * set.columns, size * set.rows);
+    auto cr = cairo_create(strip);
+    for (int i = 0; i < HOVER_CELLS; i++) {
+      auto cell =
+          theme.get_button_surface(type, get_cell_state(size, scale, i));
+      cairo_set_source_surface(cr, cell, (i % set.columns) * size,
+                               (i / set.columns) * size);
+      cairo_paint(cr);
+      cairo_surface_destroy(cell);
+    }
+
+    cairo_destroy(cr);
+    set.bytes += upload_surface_to_texture(
+        strip, set.strips[get_strip_index(type)]);
+    cairo_surface_destroy(strip);
+  }
+}
+
+void button_atlas_t::prepare(const gapsdecor_theme_t &theme, double scale) {
+  const auto key = get_strip_key(theme, scale);
+  if (strip_sets.count(key)) {
+    return;
+  }
+
+  /* The titlebar height changed, the old strips are of no use anymore. The
+   * textures release themselves, outside of the pass below. */
+  for (auto old = strip_sets.begin(); old != strip_sets.end();) {
+    old = (old->first.first != key.first) ? strip_sets.erase(old)
+                                          : std::next(old);
+  }
+
+  auto &set = strip_sets[key];
+  OpenGL::render_begin();
+  build_strips(set, theme, scale);
+  OpenGL::render_end();
+  LOGD("gapsdecor: button atlas now uses ", get_memory_usage(), " bytes");
+}
+
+bool button_atlas_t::is_prepared(const gapsdecor_theme_t &theme,
+                                 double scale) const {
+  return strip_sets.count(get_strip_key(theme, scale));
+}
+
+void button_atlas_t::render(const wf::render_target_t &fb,
+                            wf::geometry_t geometry,
+                            const gapsdecor_theme_t &theme, button_type_t type,
+                            double hover_progress) {
+  auto it = strip_sets.find(get_strip_key(theme, fb.scale));
+  if (it == strip_sets.end()) {
+    return;
+  }
+
+  const auto &strips = it->second;
+  const int cell =
+      std::clamp((int)std::round(hover_progress * HOVER_STEPS), -HOVER_STEPS,
+                 HOVER_STEPS) +
+      HOVER_STEPS;
+  const int column = cell % strips.columns;
+  const int row = cell / strips.columns;
+
+  const auto &strip = strips.strips[get_strip_index(type)];
+  const gl_geometry g = {
+      (float)geometry.x,
+      (float)geometry.y,
+      (float)(geometry.x + geometry.width),
+      (float)(geometry.y + geometry.height),
+  };
+  const gl_geometry texg = {
+      (float)column / strips.columns,
+      (float)row / strips.rows,
+      (float)(column + 1) / strips.columns,
+      (float)(row + 1) / strips.rows,
+  };
+
+  OpenGL::render_transformed_texture(
+      wf::texture_t{strip.tex}, g, texg, fb.get_orthographic_projection(),
+      glm::vec4(1.0f),
+      OpenGL::TEXTURE_TRANSFORM_INVERT_Y | OpenGL::TEXTURE_USE_TEX_GEOMETRY);
+}
+
+size_t button_atlas_t::get_memory_usage() const {
+  size_t total = 0;
+  for (auto &[key, set] : strip_sets) {
+    total += set.bytes;
+  }
+
+  return total;
+}
+} // namespace decor
+} // namespace wf
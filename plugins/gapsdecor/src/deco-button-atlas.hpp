@@ -0,0 +1,74 @@
+#pragma once
+
+#include "deco-button.hpp"
+#include <map>
+#include <utility>
+
+namespace wf {
+namespace decor {
+class gapsdecor_theme_t;
+
+/**
+ * Pre-rendered button images, shared by all decorations.
+ *
+ * For every titlebar height and output scale, each button type gets one
+ * texture: a strip with one cell per quantized hover state. All buttons of
+ * all views sample from these strips, so hovering a button or resizing a
+ * view never rasterizes or uploads anything.
+ *
+ * Strips are built by prepare(), outside of the render pass. Cells which do
+ * not fit in a single row of GL_MAX_TEXTURE_SIZE pixels wrap to more rows.
+ *
+ * Used when buttons are not drawn with shaders. A single instance is shared
+ * by all decorations, see wf::shared_data::ref_ptr_t.
+ */
+class button_atlas_t {
+public:
+  /** Number of cells per unit of hover progress */
+  static constexpr int HOVER_STEPS = 8;
+  /** Total number of cells, covering hover progress in [-1, 1] */
+  static constexpr int HOVER_CELLS = 2 * HOVER_STEPS + 1;
+
+  /**
+   * Draw a button. Must be called between OpenGL::render_begin(fb) and
+   * OpenGL::render_end(), with the scissor box already set. Nothing is
+   * drawn unless prepare() built the strips for the theme's titlebar height
+   * and the target scale.
+   */
+  void render(const wf::render_target_t &fb, wf::geometry_t geometry,
+              const gapsdecor_theme_t &theme, button_type_t type,
+              double hover_progress);
+
+  /**
+   * Build the strips for the theme's titlebar height and @scale, unless they
+   * already exist. Strips for other titlebar heights are dropped. Must not
+   * be called between OpenGL::render_begin() and OpenGL::render_end().
+   */
+  void prepare(const gapsdecor_theme_t &theme, double scale);
+
+  /** @return Whether prepare() built the strips for @theme and @scale */
+  bool is_prepared(const gapsdecor_theme_t &theme, double scale) const;
+
+  /** @return The GPU memory used by the atlas, in bytes */
+  size_t get_memory_usage() const;
+
+private:
+  struct strip_set_t {
+    /* One strip per button type */
+    wf::simple_texture_t strips[3];
+    size_t bytes = 0;
+    /* Size of a cell in pixels */
+    int cell_size = 0;
+    /* Layout of the cells in each strip */
+    int columns = HOVER_CELLS;
+    int rows = 1;
+  };
+
+  /* Keyed by titlebar height and output scale */
+  std::map<std::pair<int, double>, strip_set_t> strip_sets;
+
+  void build_strips(strip_set_t &set, const gapsdecor_theme_t &theme,
+                    double scale);
+};
+} // namespace decor
+} // namespace wf
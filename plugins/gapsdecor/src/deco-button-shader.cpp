@@ -0,0 +1,183 @@
+#include "deco-button-shader.hpp"
+#include <algorithm>
+
+static const char *button_vertex_source = R"(
+#version 100
+
+attribute mediump vec2 position;
+attribute mediump vec2 uv_in;
+attribute mediump float glyph_in;
+attribute mediump vec4 base_in;
+attribute mediump float line_in;
+
+uniform mat4 MVP;
+
+varying mediump vec2 uv;
+varying mediump float glyph;
+varying mediump vec4 base;
+varying mediump float line_alpha;
+
+void main() {
+    gl_Position = MVP * vec4(position, 0.0, 1.0);
+    uv = uv_in;
+    glyph = glyph_in;
+    base = base_in;
+    line_alpha = line_in;
+}
+)";
+
+/* The shapes and colors mirror gapsdecor_theme_t::get_button_surface(): a
+ * disc in the base color, a black circle outline, and a black glyph spanning
+ * the middle half of the button at half the alpha of the outline. All
+ * distances are in button-relative units, with (0, 0) at the top left. */
+static const char *button_fragment_source = R"(
+#version 100
+precision mediump float;
+
+varying mediump vec2 uv;
+varying mediump float glyph;
+varying mediump vec4 base;
+varying mediump float line_alpha;
+
+uniform float stroke;
+uniform float pixel;
+
+float segment(vec2 p, vec2 a, vec2 b) {
+    vec2 pa = p - a;
+    vec2 ba = b - a;
+    float h = clamp(dot(pa, ba) / dot(ba, ba), 0.0, 1.0);
+    return length(pa - ba * h);
+}
+
+float box_outline(vec2 p, vec2 center, vec2 half_size) {
+    vec2 d = abs(p - center) - half_size;
+    return abs(length(max(d, 0.0)) + min(max(d.x, d.y), 0.0));
+}
+
+/* Antialiased coverage of a shape at distance dist with the given width */
+float cover(float dist, float width) {
+    return 1.0 - smoothstep(-0.5 * pixel, 0.5 * pixel, dist - 0.5 * width);
+}
+
+void main() {
+    float radius = 0.5 - 0.5 * stroke;
+    float center_dist = length(uv - vec2(0.5));
+    float disc = cover(center_dist - 0.5, 0.0);
+    float outline = cover(abs(center_dist - radius), stroke);
+
+    float icon;
+    if (glyph < 0.5) {
+        float d = min(segment(uv, vec2(0.25, 0.25), vec2(0.75, 0.75)),
+                      segment(uv, vec2(0.75, 0.25), vec2(0.25, 0.75)));
+        icon = cover(d, 1.5 * stroke);
+    } else if (glyph < 1.5) {
+        float d = box_outline(uv, vec2(0.5), vec2(0.25));
+        icon = cover(d, 1.5 * stroke);
+    } else {
+        float d = segment(uv, vec2(0.25, 0.5), vec2(0.75, 0.5));
+        icon = cover(d, 1.75 * stroke);
+    }
+
+    /* Premultiplied alpha, painted over each other like the cairo buttons:
+     * the base, then the outline, then the glyph */
+    vec4 color = vec4(base.rgb * base.a, base.a) * disc;
+    float a = line_alpha * outline;
+    color = vec4(0.0, 0.0, 0.0, a) + color * (1.0 - a);
+    a = 0.5 * line_alpha * icon;
+    gl_FragColor = vec4(0.0, 0.0, 0.0, a) + color * (1.0 - a);
+}
+)";
+
+namespace wf {
+namespace decor {
+button_shader_t::~button_shader_t() {
+  if (compiled) {
+    OpenGL::render_begin();
+    program.free_resources();
+    OpenGL::render_end();
+  }
+}
+
+static float get_glyph_index(button_type_t type) {
+  switch (type) {
+  case BUTTON_CLOSE:
+    return 0.0;
+
+  case BUTTON_TOGGLE_MAXIMIZE:
+    return 1.0;
+
+  case BUTTON_MINIMIZE:
+    return 2.0;
+  }
+
+  return 0.0;
+}
+
+void button_shader_t::prepare() {
+  if (!compiled) {
+    OpenGL::render_begin();
+    program.compile(button_vertex_source, button_fragment_source);
+    OpenGL::render_end();
+    compiled = true;
+  }
+}
+
+void button_shader_t::render(const wf::render_target_t &fb,
+                             const std::vector<instance_t> &buttons,
+                             double stroke) {
+  if (buttons.empty() || !compiled) {
+    return;
+  }
+
+  positions.clear();
+  uvs.clear();
+  glyphs.clear();
+  bases.clear();
+  lines.clear();
+
+  /* Two triangles per button */
+  static const GLfloat corners[6][2] = {
+      {0, 1}, {1, 1}, {1, 0}, {0, 1}, {1, 0}, {0, 0},
+  };
+
+  for (auto &button : buttons) {
+    const auto &g = button.geometry;
+    const float glyph = get_glyph_index(button.type);
+    const auto &colors = button.colors;
+    const float base[4] = {
+        (float)colors.base.r,
+        (float)colors.base.g,
+        (float)colors.base.b,
+        (float)colors.base.a,
+    };
+
+    for (auto &corner : corners) {
+      positions.push_back(g.x + corner[0] * g.width);
+      positions.push_back(g.y + corner[1] * g.height);
+      uvs.push_back(corner[0]);
+      uvs.push_back(corner[1]);
+      glyphs.push_back(glyph);
+      bases.insert(bases.end(), base, base + 4);
+      lines.push_back(colors.line.a);
+    }
+  }
+
+  const double width = buttons.front().geometry.width;
+
+  program.use(wf::TEXTURE_TYPE_RGBA);
+  program.attrib_pointer("position", 2, 0, positions.data());
+  program.attrib_pointer("uv_in", 2, 0, uvs.data());
+  program.attrib_pointer("glyph_in", 1, 0, glyphs.data());
+  program.attrib_pointer("base_in", 4, 0, bases.data());
+  program.attrib_pointer("line_in", 1, 0, lines.data());
+  program.uniformMatrix4f("MVP", fb.get_orthographic_projection());
+  program.uniform1f("stroke", stroke);
+  program.uniform1f("pixel", 1.0 / std::max(1.0, width * fb.scale));
+
+  GL_CALL(glEnable(GL_BLEND));
+  GL_CALL(glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+  GL_CALL(glDrawArrays(GL_TRIANGLES, 0, 6 * buttons.size()));
+  program.deactivate();
+}
+} // namespace decor
+} // namespace wf
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "deco-button.hpp"
+#include <vector>
+#include <wayfire/opengl.hpp>
+
+namespace wf {
+namespace decor {
+/**
+ * Draws window buttons directly on the GPU, using signed distance fields for
+ * the outline and the glyph.
+ *
+ * The colors for the hover progress are vertex attributes, so animating a
+ * button only costs a redraw of its quad: nothing is rasterized or uploaded,
+ * and the glyphs stay sharp at any output scale. All buttons of a view are
+ * drawn in one batch.
+ *
+ * A single instance is shared by all decorations, see
+ * wf::shared_data::ref_ptr_t.
+ */
+class button_shader_t {
+public:
+  button_shader_t() = default;
+  ~button_shader_t();
+  button_shader_t(const button_shader_t &) = delete;
+  button_shader_t &operator=(const button_shader_t &) = delete;
+
+  using instance_t = button_instance_t;
+
+  /**
+   * Draw a set of equally sized buttons with a single draw call. Must be
+   * called between OpenGL::render_begin(fb) and OpenGL::render_end(), with
+   * the scissor box already set. Nothing is drawn until prepare() compiled
+   * the program.
+   *
+   * @param fb The target framebuffer.
+   * @param buttons The buttons to draw.
+   * @param stroke Width of the glyph strokes, relative to the button size.
+   */
+  void render(const wf::render_target_t &fb,
+              const std::vector<instance_t> &buttons, double stroke);
+
+  /**
+   * Compile the program, unless already done. Must not be called between
+   * OpenGL::render_begin() and OpenGL::render_end().
+   */
+  void prepare();
+
+  /** @return Whether prepare() compiled the program */
+  bool is_prepared() const { return compiled; }
+
+private:
+  OpenGL::program_t program;
+  bool compiled = false;
+
+  /* Vertex data, kept between calls to avoid reallocating it */
+  std::vector<GLfloat> positions;
+  std::vector<GLfloat> uvs;
+  std::vector<GLfloat> glyphs;
+  std::vector<GLfloat> bases;
+  std::vector<GLfloat> lines;
+};
+} // namespace decor
+} // namespace wf
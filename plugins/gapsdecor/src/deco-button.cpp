@@ -1,7 +1,5 @@
 #include "deco-button.hpp"
 #include "deco-theme.hpp"
-#include <wayfire/opengl.hpp>
-#include <wayfire/plugins/common/cairo-util.hpp>
 
 #define HOVERED  1.0
 #define NORMAL   0.0
@@ -15,11 +13,12 @@ button_t::button_t(const gapsdecor_theme_t& t, std::function<void()> damage) :
     theme(t), damage_callback(damage)
 {}
 
+button_t::~button_t() = default;
+
 void button_t::set_button_type(button_type_t type)
 {
     this->type = type;
     this->hover.animate(0, 0);
-    update_texture();
     add_idle_damage();
 }
 
@@ -63,41 +62,33 @@ void button_t::set_pressed(bool is_pressed)
     add_idle_damage();
 }
 
-void button_t::render(const wf::render_target_t& fb, wf::geometry_t geometry,
-    wf::geometry_t scissor)
+double button_t::get_hover_progress() const
 {
-    OpenGL::render_begin(fb);
-    fb.logic_scissor(scissor);
-    OpenGL::render_texture(button_texture.tex, fb, geometry, {1, 1, 1, 1},
-        OpenGL::TEXTURE_TRANSFORM_INVERT_Y);
-    OpenGL::render_end();
+    return hover;
+}
 
-    if (this->hover.running())
-    {
-        add_idle_damage();
-    }
+bool button_t::is_idle() const
+{
+    return !this->hover.running() && (get_hover_progress() == NORMAL);
 }
 
-void button_t::update_texture()
+button_instance_t button_t::describe(wf::geometry_t geometry, bool idle) const
 {
-    /**
-     * We render at 100% resolution
-     * When uploading the texture, this gets scaled
-     * to 70% of the titlebar height. Thus we will have
-     * a very crisp image
-     */
-    gapsdecor_theme_t::button_state_t state = {
-        .width  = 1.0 * theme.get_title_height(),
-        .height = 1.0 * theme.get_title_height(),
-        .border = 1.0,
-        .hover_progress = hover,
+    const double hover_progress = idle ? NORMAL : get_hover_progress();
+    return {
+        .geometry = geometry,
+        .type     = type,
+        .hover_progress = hover_progress,
+        .colors = theme.get_button_colors(type, hover_progress),
     };
+}
 
-    auto surface = theme.get_button_surface(type, state);
-    OpenGL::render_begin();
-    cairo_surface_upload_to_texture(surface, this->button_texture);
-    OpenGL::render_end();
-    cairo_surface_destroy(surface);
+void button_t::continue_animation()
+{
+    if (this->hover.running())
+    {
+        add_idle_damage();
+    }
 }
 
 void button_t::add_idle_damage()
@@ -105,7 +96,6 @@ void button_t::add_idle_damage()
     this->idle_damage.run_once([=] ()
     {
         this->damage_callback();
-        update_texture();
     });
 }
 }
@@ -6,6 +6,7 @@
 #include <wayfire/render-manager.hpp>
 #include <wayfire/util/duration.hpp>
 #include <wayfire/plugins/common/simple-texture.hpp>
+#include <wayfire/plugins/common/shared-core-data.hpp>
 
 #include <cairo.h>
 #include <pango/pango.h>
@@ -24,6 +25,28 @@ enum button_type_t
     BUTTON_MINIMIZE        = 1 << 2,
 };
 
+/** The colors of a button, see gapsdecor_theme_t::get_button_colors() */
+struct button_colors_t
+{
+    /* The disc behind the glyph, not premultiplied */
+    wf::color_t base;
+    /* The outline. The glyph is drawn with half of its alpha. */
+    wf::color_t line;
+};
+
+/** A button as it should be drawn, see gl_painter_t::draw_buttons() */
+struct button_instance_t
+{
+    /* The geometry of the button, in logical coordinates */
+    wf::geometry_t geometry;
+    /* The glyph to draw */
+    button_type_t type;
+    /* Progress of button hover, in range [-1, 1] */
+    double hover_progress;
+    /* The colors for the hover progress */
+    button_colors_t colors;
+};
+
 class button_t
 {
   public:
@@ -36,7 +59,7 @@ class button_t
     button_t(const gapsdecor_theme_t& theme,
         std::function<void()> damage_callback);
 
-    ~button_t() = default;
+    ~button_t();
     button_t(const button_t &) = delete;
     button_t(button_t &&) = delete;
     button_t& operator =(const button_t&) = delete;
@@ -63,23 +86,32 @@ class button_t
      */
     void set_pressed(bool is_pressed);
 
+    /** @return The current progress of the hover animation, in [-1, 1] */
+    double get_hover_progress() const;
+
     /**
-     * Render the button on the given framebuffer at the given coordinates.
-     * Precondition: set_button_type() has been called, otherwise result is no-op
+     * Describe how the button should be drawn at the given coordinates.
+     * Precondition: set_button_type() has been called.
      *
-     * @param buffer The target framebuffer
      * @param geometry The geometry of the button, in logical coordinates
-     * @param scissor The scissor rectangle to render.
+     * @param idle Describe the button as it looks when not hovered or pressed
      */
-    void render(const wf::render_target_t& buffer, wf::geometry_t geometry,
-        wf::geometry_t scissor);
+    button_instance_t describe(wf::geometry_t geometry, bool idle = false) const;
+
+    /** @return Whether the button is at rest: not hovered, pressed or animating */
+    bool is_idle() const;
+
+    /**
+     * Schedule another repaint if the hover animation is still running.
+     * Must be called after the button has been drawn.
+     */
+    void continue_animation();
 
   private:
     const gapsdecor_theme_t& theme;
 
     /* Whether the button needs repaint */
     button_type_t type;
-    wf::simple_texture_t button_texture;
 
     /* Whether the button is currently being hovered */
     bool is_hovered = false;
@@ -92,11 +124,6 @@ class button_t
     wf::wl_idle_call idle_damage;
     /** Damage button the next time the main loop goes idle */
     void add_idle_damage();
-
-    /**
-     * Redraw the button surface and store it as a texture
-     */
-    void update_texture();
 };
 }
 }
@@ -30,12 +30,15 @@ gapsdecor_area_t::gapsdecor_area_t(
   this->type = GAPSDECOR_AREA_BUTTON;
   this->geometry = g;
 
-  this->button =
-      std::make_unique<button_t>(theme, std::bind(damage_callback, g));
+  /* The area may move, so always damage its current geometry */
+  this->button = std::make_unique<button_t>(
+      theme, [this, damage_callback]() { damage_callback(this->geometry); });
 }
 
 wf::geometry_t gapsdecor_area_t::get_geometry() const { return geometry; }
 
+void gapsdecor_area_t::set_geometry(wf::geometry_t g) { this->geometry = g; }
+
 button_t &gapsdecor_area_t::as_button() {
   assert(button);
 
@@ -46,21 +49,26 @@ gapsdecor_area_type_t gapsdecor_area_t::get_type() const { return type; }
 
 gapsdecor_layout_t::gapsdecor_layout_t(const gapsdecor_theme_t &th,
                                          std::function<void(wlr_box)> callback)
-    :
-
-      titlebar_size(th.get_title_height()), border_size(th.get_border_size()),
-      /**
-       * This is necessary. Otherwise, we will draw an
-       * overly huge button. 70% of the titlebar height
-       * is a decent size. (Equals 21 px by default)
-       */
-      button_width(titlebar_size * BUTTON_HEIGHT_PC),
-      button_height(titlebar_size * BUTTON_HEIGHT_PC),
-      button_padding((titlebar_size - button_height) / 2), theme(th),
-      damage_callback(callback) {}
-
-wf::geometry_t gapsdecor_layout_t::create_buttons(int width, int) {
-  std::stringstream stream((std::string)button_order);
+    : theme(th), damage_callback(callback) {
+  reload_theme();
+}
+
+void gapsdecor_layout_t::reload_theme() {
+  this->titlebar_size = theme.get_title_height();
+  this->border_size = theme.get_border_size();
+  /**
+   * This is necessary. Otherwise, we will draw an
+   * overly huge button. 70% of the titlebar height
+   * is a decent size. (Equals 21 px by default)
+   */
+  this->button_width = titlebar_size * BUTTON_HEIGHT_PC;
+  this->button_height = titlebar_size * BUTTON_HEIGHT_PC;
+  this->button_padding = (titlebar_size - button_height) / 2;
+  this->areas_dirty = true;
+}
+
+void gapsdecor_layout_t::create_areas() {
+  std::stringstream stream(theme.get_button_order());
   std::vector<button_type_t> buttons;
   std::string button_name;
   while (stream >> button_name) {
@@ -78,37 +86,77 @@ wf::geometry_t gapsdecor_layout_t::create_buttons(int width, int) {
     }
   }
 
-  int per_button = 2 * button_padding + button_width;
-  wf::geometry_t button_geometry = {
-      width - border_size + button_padding, /* 1 more padding initially */
-      button_padding + border_size,
-      button_width,
-      button_height,
-  };
+  this->layout_areas.clear();
+  this->num_buttons = 0;
+  if (this->titlebar_size > 0) {
+    for (auto type : wf::reverse(buttons)) {
+      this->layout_areas.push_back(std::make_unique<gapsdecor_area_t>(
+          wf::geometry_t{}, damage_callback, theme));
+      this->layout_areas.back()->as_button().set_button_type(type);
+    }
+
+    this->num_buttons = buttons.size();
 
-  for (auto type : wf::reverse(buttons)) {
-    button_geometry.x -= per_button;
+    /* Padding around the button, allows move */
     this->layout_areas.push_back(std::make_unique<gapsdecor_area_t>(
-        button_geometry, damage_callback, theme));
-    this->layout_areas.back()->as_button().set_button_type(type);
+        GAPSDECOR_AREA_MOVE, wf::geometry_t{}));
+
+    /* Titlebar dragging area (for move) */
+    this->layout_areas.push_back(std::make_unique<gapsdecor_area_t>(
+        GAPSDECOR_AREA_TITLE, wf::geometry_t{}));
   }
 
-  int total_width = -button_padding + buttons.size() * per_button;
+  /* Resizing edges */
+  for (auto type : {GAPSDECOR_AREA_RESIZE_LEFT, GAPSDECOR_AREA_RESIZE_RIGHT,
+                    GAPSDECOR_AREA_RESIZE_TOP, GAPSDECOR_AREA_RESIZE_BOTTOM}) {
+    this->layout_areas.push_back(
+        std::make_unique<gapsdecor_area_t>(type, wf::geometry_t{}));
+  }
+
+  this->renderable_areas.clear();
+  for (auto &area : layout_areas) {
+    if (area->get_type() & GAPSDECOR_AREA_RENDERABLE_BIT) {
+      renderable_areas.push_back(nonstd::make_observer(area.get()));
+    }
+  }
 
-  return {button_geometry.x, border_size, total_width, titlebar_size};
+  this->created_button_flags = theme.button_flags;
+  this->areas_dirty = false;
 }
 
-/** Regenerate layout using the new size */
+/**
+ * Update the geometry of the layout areas for the new size.
+ * The areas themselves, and thus the buttons and their state, are kept.
+ */
 void gapsdecor_layout_t::resize(int width, int height) {
-  this->layout_areas.clear();
+  if (areas_dirty || (created_button_flags != theme.button_flags)) {
+    create_areas();
+  }
+
+  this->layout_width = width;
+  this->layout_height = height;
+
+  size_t idx = 0;
   if (this->titlebar_size > 0) {
-    auto button_geometry_expanded = create_buttons(width, height);
+    int per_button = 2 * button_padding + button_width;
+    wf::geometry_t button_geometry = {
+        width - border_size + button_padding, /* 1 more padding initially */
+        button_padding + border_size,
+        button_width,
+        button_height,
+    };
 
-    /* Padding around the button, allows move */
-    this->layout_areas.push_back(std::make_unique<gapsdecor_area_t>(
-        GAPSDECOR_AREA_MOVE, button_geometry_expanded));
+    for (; idx < num_buttons; idx++) {
+      button_geometry.x -= per_button;
+      layout_areas[idx]->set_geometry(button_geometry);
+    }
+
+    this->buttons_x = button_geometry.x;
+    int total_width = -button_padding + num_buttons * per_button;
+    wf::geometry_t button_geometry_expanded = {
+        button_geometry.x, border_size, total_width, titlebar_size};
+    layout_areas[idx++]->set_geometry(button_geometry_expanded);
 
-    /* Titlebar dragging area (for move) */
     wf::geometry_t title_geometry = {
         border_size,
         border_size,
@@ -117,45 +165,25 @@ void gapsdecor_layout_t::resize(int width, int height) {
         button_geometry_expanded.x - border_size,
         titlebar_size,
     };
-    this->layout_areas.push_back(std::make_unique<gapsdecor_area_t>(
-        GAPSDECOR_AREA_TITLE, title_geometry));
+    layout_areas[idx++]->set_geometry(title_geometry);
   }
 
-  /* Resizing edges - left */
-  wf::geometry_t border_geometry = {0, 0, border_size, height};
-  this->layout_areas.push_back(std::make_unique<gapsdecor_area_t>(
-      GAPSDECOR_AREA_RESIZE_LEFT, border_geometry));
-
-  /* Resizing edges - right */
-  border_geometry = {width - border_size, 0, border_size, height};
-  this->layout_areas.push_back(std::make_unique<gapsdecor_area_t>(
-      GAPSDECOR_AREA_RESIZE_RIGHT, border_geometry));
-
-  /* Resizing edges - top */
-  border_geometry = {0, 0, width, border_size};
-  this->layout_areas.push_back(std::make_unique<gapsdecor_area_t>(
-      GAPSDECOR_AREA_RESIZE_TOP, border_geometry));
-
-  /* Resizing edges - bottom */
-  border_geometry = {0, height - border_size, width, border_size};
-  this->layout_areas.push_back(std::make_unique<gapsdecor_area_t>(
-      GAPSDECOR_AREA_RESIZE_BOTTOM, border_geometry));
+  /* Resizing edges - left, right, top, bottom */
+  layout_areas[idx++]->set_geometry({0, 0, border_size, height});
+  layout_areas[idx++]->set_geometry(
+      {width - border_size, 0, border_size, height});
+  layout_areas[idx++]->set_geometry({0, 0, width, border_size});
+  layout_areas[idx++]->set_geometry(
+      {0, height - border_size, width, border_size});
 }
 
 /**
  * @return The gapsdecor areas which need to be rendered, in top to bottom
  *  order.
  */
-std::vector<nonstd::observer_ptr<gapsdecor_area_t>>
-gapsdecor_layout_t::get_renderable_areas() {
-  std::vector<nonstd::observer_ptr<gapsdecor_area_t>> renderable;
-  for (auto &area : layout_areas) {
-    if (area->get_type() & GAPSDECOR_AREA_RENDERABLE_BIT) {
-      renderable.push_back({area});
-    }
-  }
-
-  return renderable;
+const std::vector<nonstd::observer_ptr<gapsdecor_area_t>> &
+gapsdecor_layout_t::get_renderable_areas() const {
+  return renderable_areas;
 }
 
 wf::region_t gapsdecor_layout_t::calculate_region() const {
@@ -181,7 +209,8 @@ void gapsdecor_layout_t::unset_hover(std::optional<wf::point_t> position) {
 gapsdecor_layout_t::action_response_t
 gapsdecor_layout_t::handle_motion(int x, int y) {
   auto previous_area = find_area_at(current_input);
-  auto current_area = find_area_at(wf::point_t{x, y});
+  auto current = classify(wf::point_t{x, y});
+  auto current_area = current.area;
 
   if (previous_area == current_area) {
     if (is_grabbed && current_area &&
@@ -197,7 +226,7 @@ gapsdecor_layout_t::handle_motion(int x, int y) {
   }
 
   this->current_input = {x, y};
-  update_cursor();
+  update_cursor(current.edges);
 
   return {GAPSDECOR_ACTION_NONE, 0};
 }
@@ -265,51 +294,103 @@ gapsdecor_layout_t::handle_press_event(bool pressed) {
 }
 
 /**
- * Find the layout area at the given coordinates, if any
- * @return The layout area or null on failure
+ * Determine the area and resize edges at the given point.
+ *
+ * The layout is a fixed arrangement of bands: borders on each side, and the
+ * titlebar with a row of equally spaced buttons. So instead of testing every
+ * area, the result is computed directly from the coordinates. Areas are
+ * resolved in the same order as they are stored in @layout_areas.
  */
-nonstd::observer_ptr<gapsdecor_area_t>
-gapsdecor_layout_t::find_area_at(std::optional<wf::point_t> point) {
-  if (!point) {
-    return nullptr;
+gapsdecor_layout_t::hit_t
+gapsdecor_layout_t::classify(std::optional<wf::point_t> point) const {
+  if (!point || layout_areas.empty()) {
+    return {nullptr, 0};
   }
 
-  for (auto &area : this->layout_areas) {
-    if (area->get_geometry() & *point) {
-      return {area};
-    }
-  }
+  const int x = point->x;
+  const int y = point->y;
+  const int w = layout_width;
+  const int h = layout_height;
+  auto in_range = [](int v, int start, int length) {
+    return (v >= start) && (v < start + length);
+  };
+  auto area_at_index = [&](size_t idx) {
+    return nonstd::make_observer(layout_areas[idx].get());
+  };
 
-  return nullptr;
-}
+  uint32_t edges = 0;
+  if (in_range(y, 0, h)) {
+    edges |= in_range(x, 0, border_size) ? WLR_EDGE_LEFT : 0;
+    edges |= in_range(x, w - border_size, border_size) ? WLR_EDGE_RIGHT : 0;
+  }
 
-/** Calculate resize edges based on @current_input */
-uint32_t gapsdecor_layout_t::calculate_resize_edges() const {
-  if (!this->current_input.has_value()) {
-    return 0;
+  if (in_range(x, 0, w)) {
+    edges |= in_range(y, 0, border_size) ? WLR_EDGE_TOP : 0;
+    edges |= in_range(y, h - border_size, border_size) ? WLR_EDGE_BOTTOM : 0;
   }
 
-  uint32_t edges = 0;
-  for (auto &area : layout_areas) {
-    if (area->get_geometry() & *this->current_input) {
-      if (area->get_type() & GAPSDECOR_AREA_RESIZE_BIT) {
-        edges |= (area->get_type() & ~GAPSDECOR_AREA_RESIZE_BIT);
+  if (titlebar_size > 0) {
+    const int per_button = 2 * button_padding + button_width;
+    const int dx = x - buttons_x;
+    if (in_range(y, border_size + button_padding, button_height) &&
+        in_range(dx, 0, (int)num_buttons * per_button) &&
+        (dx % per_button < button_width)) {
+      /* Buttons are stored from right to left */
+      return {area_at_index(num_buttons - 1 - dx / per_button), edges};
+    }
+
+    if (in_range(y, border_size, titlebar_size)) {
+      const int buttons_width =
+          -button_padding + (int)num_buttons * per_button;
+      if (in_range(x, buttons_x, buttons_width)) {
+        return {area_at_index(num_buttons), edges};
+      }
+
+      if (in_range(x, border_size, buttons_x - border_size)) {
+        return {area_at_index(num_buttons + 1), edges};
       }
     }
   }
 
-  return edges;
+  const size_t first_edge = (titlebar_size > 0) ? num_buttons + 2 : 0;
+  const uint32_t edge_order[] = {WLR_EDGE_LEFT, WLR_EDGE_RIGHT, WLR_EDGE_TOP,
+                                 WLR_EDGE_BOTTOM};
+  for (size_t i = 0; i < 4; i++) {
+    if (edges & edge_order[i]) {
+      return {area_at_index(first_edge + i), edges};
+    }
+  }
+
+  return {nullptr, edges};
+}
+
+/**
+ * Find the layout area at the given coordinates, if any
+ * @return The layout area or null on failure
+ */
+nonstd::observer_ptr<gapsdecor_area_t>
+gapsdecor_layout_t::find_area_at(std::optional<wf::point_t> point) {
+  return classify(point).area;
 }
 
-/** Update the cursor based on @current_input */
-void gapsdecor_layout_t::update_cursor() const {
-  uint32_t edges = calculate_resize_edges();
-  auto cursor_name =
+/** Calculate resize edges based on @current_input */
+uint32_t gapsdecor_layout_t::calculate_resize_edges() const {
+  return classify(current_input).edges;
+}
+
+/** Update the cursor for the given resize edges, if it changed */
+void gapsdecor_layout_t::update_cursor(uint32_t edges) {
+  const char *cursor_name =
       edges > 0 ? wlr_xcursor_get_resize_name((wlr_edges)edges) : "default";
-  wf::get_core().set_cursor(cursor_name);
+  if (current_cursor != cursor_name) {
+    current_cursor = cursor_name;
+    wf::get_core().set_cursor(cursor_name);
+  }
 }
 
 void gapsdecor_layout_t::handle_focus_lost() {
+  /* Somebody else controls the cursor now */
+  this->current_cursor.clear();
   if (is_grabbed) {
     this->is_grabbed = false;
     auto area = find_area_at(grab_origin);
@@ -320,5 +401,10 @@ void gapsdecor_layout_t::handle_focus_lost() {
 
   this->unset_hover(current_input);
 }
+
+void gapsdecor_layout_t::release_resources() {
+  timer.disconnect();
+  double_click_at_release = false;
+}
 } // namespace decor
 } // namespace wf
@@ -46,6 +46,9 @@ public:
   /** @return The geometry of the gapsdecor area, relative to the layout */
   wf::geometry_t get_geometry() const;
 
+  /** Move the area to the given geometry, relative to the layout */
+  void set_geometry(wf::geometry_t g);
+
   /** @return The area's button, if the area is a button. Otherwise UB */
   button_t &as_button();
 
@@ -93,14 +96,18 @@ public:
   gapsdecor_layout_t(const gapsdecor_theme_t &theme,
                      std::function<void(wlr_box)> damage_callback);
 
-  /** Regenerate layout using the new size */
+  /**
+   * Update the layout for the new size. Only the geometry of the areas
+   * changes, buttons and their state are preserved.
+   */
   void resize(int width, int height);
 
   /**
    * @return The gapsdecor areas which need to be rendered, in top to bottom
    *  order.
    */
-  std::vector<nonstd::observer_ptr<gapsdecor_area_t>> get_renderable_areas();
+  const std::vector<nonstd::observer_ptr<gapsdecor_area_t>> &
+  get_renderable_areas() const;
 
   /** @return The combined region of all layout areas */
   wf::region_t calculate_region() const;
@@ -128,17 +135,34 @@ public:
    */
   void handle_focus_lost();
 
+  /** Cancel pending timers, for ex. when the decoration is hidden */
+  void release_resources();
+
+  /**
+   * Pick up the sizes of the theme after its options changed. The areas are
+   * created again, so resize() must be called afterwards.
+   */
+  void reload_theme();
+
 private:
-  const int titlebar_size;
-  const int border_size;
-  const int button_width;
-  const int button_height;
-  const int button_padding;
+  int titlebar_size;
+  int border_size;
+  int button_width;
+  int button_height;
+  int button_padding;
   const gapsdecor_theme_t &theme;
 
   std::function<void(wlr_box)> damage_callback;
 
+  /* Buttons from right to left, then the move and title areas (only with a
+   * titlebar), then the left, right, top and bottom resize edges */
   std::vector<std::unique_ptr<gapsdecor_area_t>> layout_areas;
+  size_t num_buttons = 0;
+  /* The areas which need to be rendered, in top to bottom order */
+  std::vector<nonstd::observer_ptr<gapsdecor_area_t>> renderable_areas;
+  /* Whether the areas need to be created again, e.g. the theme changed */
+  bool areas_dirty = true;
+  button_type_t created_button_flags = button_type_t(0);
 
   bool is_grabbed = false;
   /* Position where the grab has started */
@@ -149,13 +173,29 @@ private:
   wf::wl_timer<false> timer;
   bool double_click_at_release = false;
 
-  /** Create buttons in the layout, and return their total geometry */
-  wf::geometry_t create_buttons(int width, int height);
+  /** Create the buttons and other areas of the layout, without geometry */
+  void create_areas();
+
+  /* Layout size and position of the leftmost button, for hit-testing */
+  int layout_width = 0;
+  int layout_height = 0;
+  int buttons_x = 0;
+  /* The cursor last set by the layout, empty if unknown */
+  std::string current_cursor;
+
+  struct hit_t {
+    nonstd::observer_ptr<gapsdecor_area_t> area;
+    /* Resize edges at the point */
+    uint32_t edges;
+  };
+
+  /** Find the area and resize edges at the given point in constant time */
+  hit_t classify(std::optional<wf::point_t> point) const;
 
   /** Calculate resize edges based on @current_input */
   uint32_t calculate_resize_edges() const;
-  /** Update the cursor based on @current_input */
-  void update_cursor() const;
+  /** Update the cursor for the given resize edges, if it changed */
+  void update_cursor(uint32_t edges);
 
   /**
    * Find the layout area at the given coordinates, if any
@@ -166,7 +206,6 @@ private:
 
   /** Unset hover state of hovered button at @position, if any */
   void unset_hover(std::optional<wf::point_t> position);
-  wf::option_wrapper_t<std::string> button_order{"gapsdecor/button_order"};
 };
 } // namespace decor
 } // namespace wf
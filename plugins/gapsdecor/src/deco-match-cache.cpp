@@ -0,0 +1,102 @@
+#include "deco-match-cache.hpp"
+#include <utility>
+#include <wayfire/core.hpp>
+
+namespace wf {
+namespace decor {
+static const std::string cached_match_name = "gapsdecor-ignore-views";
+
+bool match_cache_t::inputs_t::operator==(const inputs_t &other) const {
+  return title == other.title && app_id == other.app_id &&
+         tiled_edges == other.tiled_edges && fullscreen == other.fullscreen &&
+         minimized == other.minimized && activated == other.activated;
+}
+
+match_cache_t::match_cache_t() {
+  update_dependencies();
+  criteria.set_callback([=]() {
+    update_dependencies();
+    ++generation;
+    ++stats.invalidations;
+  });
+}
+
+void match_cache_t::update_dependencies() {
+  const std::string text = criteria;
+  const std::pair<const char *, dependency_t> keywords[] = {
+      {"title", DEPENDS_TITLE},
+      {"app_id", DEPENDS_APP_ID},
+      {"tiled", DEPENDS_TILING},
+      {"maximized", DEPENDS_TILING},
+      {"floating", DEPENDS_TILING},
+      {"fullscreen", DEPENDS_FULLSCREEN},
+      {"minimized", DEPENDS_MINIMIZED},
+      {"activated", DEPENDS_ACTIVATED},
+  };
+
+  dependencies = 0;
+  for (auto &[keyword, dependency] : keywords) {
+    if (text.find(keyword) != std::string::npos) {
+      dependencies |= dependency;
+    }
+  }
+}
+
+match_cache_t::inputs_t
+match_cache_t::get_inputs(wayfire_toplevel_view view) const {
+  inputs_t inputs;
+  if (dependencies & DEPENDS_TITLE) {
+    inputs.title = view->get_title();
+  }
+
+  if (dependencies & DEPENDS_APP_ID) {
+    inputs.app_id = view->get_app_id();
+  }
+
+  if (dependencies & DEPENDS_TILING) {
+    inputs.tiled_edges = view->pending_tiled_edges();
+  }
+
+  if (dependencies & DEPENDS_FULLSCREEN) {
+    inputs.fullscreen = view->pending_fullscreen();
+  }
+
+  if (dependencies & DEPENDS_MINIMIZED) {
+    inputs.minimized = view->minimized;
+  }
+
+  if (dependencies & DEPENDS_ACTIVATED) {
+    inputs.activated = view->activated;
+  }
+
+  return inputs;
+}
+
+bool match_cache_t::matches(wayfire_toplevel_view view) {
+  auto inputs = get_inputs(view);
+  auto cached = view->get_data<cached_match_t>(cached_match_name);
+  if (cached && (cached->generation == generation) &&
+      (cached->inputs == inputs)) {
+    ++stats.hits;
+    return cached->matches;
+  }
+
+  ++stats.misses;
+  if (!cached) {
+    view->store_data(std::make_unique<cached_match_t>(), cached_match_name);
+    cached = view->get_data<cached_match_t>(cached_match_name);
+  }
+
+  cached->generation = generation;
+  cached->inputs = std::move(inputs);
+  cached->matches = ignore_views.matches(view);
+  return cached->matches;
+}
+
+void match_cache_t::clear() {
+  for (auto &view : wf::get_core().get_all_views()) {
+    view->erase_data(cached_match_name);
+  }
+}
+} // namespace decor
+} // namespace wf
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <wayfire/matcher.hpp>
+#include <wayfire/object.hpp>
+#include <wayfire/option-wrapper.hpp>
+#include <wayfire/toplevel-view.hpp>
+
+namespace wf {
+namespace decor {
+struct match_cache_stats_t {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  /* Times the criteria changed, which drops every cached result */
+  uint64_t invalidations = 0;
+};
+
+/**
+ * Whether views match gapsdecor/ignore_views, remembered per view.
+ *
+ * The criteria are scanned for the view properties they can depend on.
+ * A cached result stays valid until one of those properties changes, or
+ * until the criteria themselves change. Properties which are fixed for the
+ * lifetime of a view, like its type, never invalidate the result.
+ */
+class match_cache_t {
+public:
+  match_cache_t();
+  match_cache_t(const match_cache_t &) = delete;
+  match_cache_t &operator=(const match_cache_t &) = delete;
+
+  /** @return Whether @view matches gapsdecor/ignore_views */
+  bool matches(wayfire_toplevel_view view);
+
+  /** Drop the cached results of all views, for ex. when unloading */
+  void clear();
+
+  /** @return The hit/miss counters */
+  match_cache_stats_t get_stats() const { return stats; }
+
+private:
+  /* The mutable view properties the criteria may refer to */
+  enum dependency_t {
+    DEPENDS_TITLE = 1 << 0,
+    DEPENDS_APP_ID = 1 << 1,
+    DEPENDS_TILING = 1 << 2,
+    DEPENDS_FULLSCREEN = 1 << 3,
+    DEPENDS_MINIMIZED = 1 << 4,
+    DEPENDS_ACTIVATED = 1 << 5,
+  };
+
+  /** The values of the properties a result was computed from */
+  struct inputs_t {
+    std::string title;
+    std::string app_id;
+    uint32_t tiled_edges = 0;
+    bool fullscreen = false;
+    bool minimized = false;
+    bool activated = false;
+
+    bool operator==(const inputs_t &other) const;
+  };
+
+  /** A cached result, stored on the view */
+  struct cached_match_t : public wf::custom_data_t {
+    uint64_t generation;
+    inputs_t inputs;
+    bool matches;
+  };
+
+  inputs_t get_inputs(wayfire_toplevel_view view) const;
+  /** Find out which properties the current criteria refer to */
+  void update_dependencies();
+
+  wf::view_matcher_t ignore_views{"gapsdecor/ignore_views"};
+  wf::option_wrapper_t<std::string> criteria{"gapsdecor/ignore_views"};
+  uint32_t dependencies = 0;
+  /* Bumped whenever the criteria change, older results are stale */
+  uint64_t generation = 0;
+  match_cache_stats_t stats;
+};
+} // namespace decor
+} // namespace wf
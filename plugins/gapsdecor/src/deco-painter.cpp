@@ -0,0 +1,67 @@
+#include "deco-painter.hpp"
+#include "deco-button-atlas.hpp"
+#include "deco-button-shader.hpp"
+#include "deco-theme.hpp"
+
+namespace wf {
+namespace decor {
+gl_painter_t::gl_painter_t() = default;
+gl_painter_t::~gl_painter_t() = default;
+
+void gl_painter_t::begin(const wf::render_target_t &fb) {
+  this->fb = &fb;
+  OpenGL::render_begin(fb);
+}
+
+void gl_painter_t::end() {
+  OpenGL::render_end();
+  this->fb = nullptr;
+}
+
+void gl_painter_t::set_clip(const wf::geometry_t &box) {
+  fb->logic_scissor(box);
+}
+
+void gl_painter_t::draw_title(const wf::simple_texture_t &title,
+                              const wf::geometry_t &box) {
+  /* Cairo surfaces are uploaded upside down */
+  OpenGL::render_texture(title.tex, *fb, box, glm::vec4(1.0f),
+                         OpenGL::TEXTURE_TRANSFORM_INVERT_Y);
+}
+
+void gl_painter_t::draw_buttons(const std::vector<button_instance_t> &buttons,
+                                const gapsdecor_theme_t &theme) {
+  if (buttons.empty() || !is_prepared(theme, fb->scale)) {
+    return;
+  }
+
+  if (theme.has_shader_buttons()) {
+    shader->render(*fb, buttons, theme.get_button_stroke());
+    return;
+  }
+
+  for (const auto &button : buttons) {
+    atlas->render(*fb, button.geometry, theme, button.type,
+                  button.hover_progress);
+  }
+}
+
+void gl_painter_t::prepare(const gapsdecor_theme_t &theme, double scale) {
+  if (theme.has_shader_buttons()) {
+    shader->prepare();
+  } else {
+    atlas->prepare(theme, scale);
+  }
+}
+
+bool gl_painter_t::is_prepared(const gapsdecor_theme_t &theme,
+                               double scale) {
+  return theme.has_shader_buttons() ? shader->is_prepared()
+                                    : atlas->is_prepared(theme, scale);
+}
+
+void gl_painter_t::draw_texture(GLuint texture, const wf::geometry_t &box) {
+  OpenGL::render_texture(wf::texture_t{texture}, *fb, box, glm::vec4(1.0f));
+}
+} // namespace decor
+} // namespace wf
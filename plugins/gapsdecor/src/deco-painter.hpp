@@ -0,0 +1,65 @@
+#pragma once
+
+#include "deco-button.hpp"
+#include <vector>
+#include <wayfire/opengl.hpp>
+#include <wayfire/plugins/common/shared-core-data.hpp>
+#include <wayfire/plugins/common/simple-texture.hpp>
+
+namespace wf {
+namespace decor {
+class gapsdecor_theme_t;
+class button_shader_t;
+class button_atlas_t;
+
+/**
+ * Draws the parts of a decoration with OpenGL: titles, composited titlebars
+ * and buttons, the latter with shaders or from the shared button atlas.
+ * All coordinates are logical, and all operations must happen between
+ * begin() and end().
+ */
+class gl_painter_t {
+public:
+  gl_painter_t();
+  ~gl_painter_t();
+
+  /** Start drawing on @fb, which must outlive the call to end() */
+  void begin(const wf::render_target_t &fb);
+  void end();
+
+  /** Restrict the following operations to @box */
+  void set_clip(const wf::geometry_t &box);
+
+  /** Draw a rasterized title, stretched to @box */
+  void draw_title(const wf::simple_texture_t &title, const wf::geometry_t &box);
+
+  /**
+   * Draw @buttons with the glyphs and colors of @theme. Nothing is drawn
+   * unless prepare() was called for @theme at the target scale.
+   */
+  void draw_buttons(const std::vector<button_instance_t> &buttons,
+                    const gapsdecor_theme_t &theme);
+
+  /** Draw a texture rendered by Wayfire, e.g. a wf::framebuffer_base_t */
+  void draw_texture(GLuint texture, const wf::geometry_t &box);
+
+  /**
+   * Compile the shaders or build the textures that drawing buttons with
+   * @theme at @scale needs, unless already done. Must be called outside of
+   * begin()/end(), so that drawing never has to.
+   */
+  void prepare(const gapsdecor_theme_t &theme, double scale);
+
+  /** @return Whether buttons of @theme can be drawn at @scale */
+  bool is_prepared(const gapsdecor_theme_t &theme, double scale);
+
+private:
+  const wf::render_target_t *fb = nullptr;
+
+  /* Draws the buttons when shader buttons are enabled */
+  wf::shared_data::ref_ptr_t<button_shader_t> shader;
+  /* Pre-rendered button images, used without shader buttons */
+  wf::shared_data::ref_ptr_t<button_atlas_t> atlas;
+};
+} // namespace decor
+} // namespace wf
@@ -0,0 +1,129 @@
+#include "deco-raster-pool.hpp"
+#include <algorithm>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <wayfire/core.hpp>
+#include <wayfire/debug.hpp>
+
+/* Title rasterization is cheap per job, a couple of threads are plenty */
+#define MAX_RASTER_WORKERS 2
+
+namespace wf {
+namespace decor {
+raster_pool_t::raster_pool_t() {
+  event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (event_fd < 0) {
+    LOGE("gapsdecor: failed to create eventfd for the raster pool");
+  } else {
+    event_source = wl_event_loop_add_fd(wf::get_core().ev_loop, event_fd,
+                                        WL_EVENT_READABLE, handle_results, this);
+  }
+
+  int count = std::clamp<int>(std::thread::hardware_concurrency() / 2, 1,
+                              MAX_RASTER_WORKERS);
+  for (int i = 0; i < count; i++) {
+    workers.emplace_back([=]() { worker_main(); });
+  }
+}
+
+raster_pool_t::~raster_pool_t() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  has_jobs.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  /* Nobody is interested in results anymore */
+  for (auto &result : results) {
+    cairo_surface_destroy(result.surface);
+  }
+
+  if (event_source) {
+    wl_event_source_remove(event_source);
+  }
+
+  if (event_fd >= 0) {
+    close(event_fd);
+  }
+}
+
+void raster_pool_t::submit(job_t job, done_t done) {
+  if (event_source == nullptr) {
+    /* No way to get back to the main loop from a worker, rasterize on the
+     * main thread once idle. This also keeps the GL upload in @done out of
+     * any render pass the caller may be in. */
+    deferred.emplace_back(std::move(job), std::move(done));
+    idle_deferred.run_once([=]() { run_deferred(); });
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.emplace_back(std::move(job), std::move(done));
+  }
+
+  has_jobs.notify_one();
+}
+
+void raster_pool_t::run_deferred() {
+  auto pending = std::move(deferred);
+  deferred.clear();
+  for (auto &[job, done] : pending) {
+    done(job());
+  }
+}
+
+void raster_pool_t::worker_main() {
+  while (true) {
+    std::pair<job_t, done_t> item;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      has_jobs.wait(lock, [&]() { return stopping || !jobs.empty(); });
+      if (stopping) {
+        return;
+      }
+
+      item = std::move(jobs.front());
+      jobs.pop_front();
+    }
+
+    auto surface = item.first();
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      results.push_back({surface, std::move(item.second)});
+    }
+
+    uint64_t one = 1;
+    if (write(event_fd, &one, sizeof(one)) < 0) {
+      LOGE("gapsdecor: failed to signal finished raster job");
+    }
+  }
+}
+
+int raster_pool_t::handle_results(int fd, uint32_t, void *data) {
+  /* The counter is only used as a wakeup, its value is irrelevant */
+  uint64_t count;
+  ssize_t ret = read(fd, &count, sizeof(count));
+  (void)ret;
+
+  static_cast<raster_pool_t *>(data)->dispatch_results();
+  return 0;
+}
+
+void raster_pool_t::dispatch_results() {
+  std::vector<result_t> finished;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::swap(finished, results);
+  }
+
+  for (auto &result : finished) {
+    result.done(result.surface);
+  }
+}
+} // namespace decor
+} // namespace wf
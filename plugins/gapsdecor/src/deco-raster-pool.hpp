@@ -0,0 +1,69 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <cairo.h>
+#include <wayfire/util.hpp>
+#include <wayland-server-core.h>
+
+namespace wf {
+namespace decor {
+/**
+ * A small pool of worker threads which produce cairo surfaces in the
+ * background, so that text layout never happens on the render path.
+ *
+ * Jobs must not touch compositor state: everything they need has to be
+ * captured by value. Completion callbacks run on the main thread, from the
+ * Wayland event loop.
+ */
+class raster_pool_t {
+public:
+  /** Produces a surface, runs on a worker thread */
+  using job_t = std::function<cairo_surface_t *()>;
+  /** Receives the produced surface on the main thread and takes ownership */
+  using done_t = std::function<void(cairo_surface_t *)>;
+
+  raster_pool_t();
+  ~raster_pool_t();
+  raster_pool_t(const raster_pool_t &) = delete;
+  raster_pool_t &operator=(const raster_pool_t &) = delete;
+
+  /**
+   * Queue @job on a worker and call @done with its result once finished.
+   * @done is never called before submit() returns.
+   */
+  void submit(job_t job, done_t done);
+
+private:
+  struct result_t {
+    cairo_surface_t *surface;
+    done_t done;
+  };
+
+  std::mutex mutex;
+  std::condition_variable has_jobs;
+  std::deque<std::pair<job_t, done_t>> jobs;
+  std::vector<result_t> results;
+  bool stopping = false;
+  std::vector<std::thread> workers;
+
+  /* Wakes up the main loop when results are available */
+  int event_fd = -1;
+  wl_event_source *event_source = nullptr;
+
+  /* Jobs run on the main thread when workers cannot wake up the main loop */
+  std::vector<std::pair<job_t, done_t>> deferred;
+  wf::wl_idle_call idle_deferred;
+
+  void worker_main();
+  void run_deferred();
+  static int handle_results(int fd, uint32_t mask, void *data);
+  void dispatch_results();
+};
+} // namespace decor
+} // namespace wf
@@ -0,0 +1,116 @@
+#include "deco-residency.hpp"
+#include "deco-stats.hpp"
+#include <algorithm>
+#include <iterator>
+#include <wayfire/util/log.hpp>
+
+/* How often hidden decorations are looked for, in milliseconds */
+#define SWEEP_INTERVAL 1000
+/* Decorations drawn more recently than this are never released to meet the
+ * budget, for ex. while they are hidden by a workspace switch animation */
+#define RECENTLY_USED 100
+
+namespace wf {
+namespace decor {
+void residency_manager_t::touch(resident_t *object) {
+  const uint32_t now = wf::get_current_time();
+  auto it = index.find(object);
+  if (it != index.end()) {
+    it->second->last_used = now;
+    lru.splice(lru.begin(), lru, it->second);
+  } else {
+    lru.push_front({object, now});
+    index[object] = lru.begin();
+  }
+
+  if (!sweep_timer.is_connected()) {
+    sweep_timer.set_timeout(SWEEP_INTERVAL, [=]() {
+      sweep();
+      return !lru.empty();
+    });
+  }
+
+  /* The object may just have rebuilt its textures */
+  idle_enforce.run_once([=]() { enforce_budget(); });
+}
+
+void residency_manager_t::remove(resident_t *object) {
+  auto it = index.find(object);
+  if (it != index.end()) {
+    lru.erase(it->second);
+    index.erase(it);
+  }
+
+  if (lru.empty()) {
+    sweep_timer.disconnect();
+    idle_enforce.disconnect();
+  }
+}
+
+size_t residency_manager_t::get_resident_bytes() const {
+  std::unordered_set<const void *> shared;
+  size_t total = 0;
+  for (const auto &entry : lru) {
+    total += entry.object->get_resident_bytes(shared);
+  }
+
+  return total;
+}
+
+void residency_manager_t::release(std::list<entry_t>::iterator it) {
+  it->object->release_resources();
+  ++releases;
+  ++global_stats().decorations_released;
+}
+
+void residency_manager_t::sweep() {
+  const int timeout = release_after;
+  if (timeout < 0) {
+    return;
+  }
+
+  const uint32_t now = wf::get_current_time();
+  for (auto it = lru.begin(); it != lru.end(); ++it) {
+    std::unordered_set<const void *> shared;
+    if ((now - it->last_used >= (uint32_t)timeout) &&
+        it->object->get_resident_bytes(shared) && !it->object->is_visible()) {
+      release(it);
+    }
+  }
+}
+
+void residency_manager_t::enforce_budget() {
+  const int budget_kib = budget;
+  if (budget_kib <= 0) {
+    return;
+  }
+
+  const size_t limit = size_t(budget_kib) * 1024;
+  size_t total = get_resident_bytes();
+  if (total <= limit) {
+    return;
+  }
+
+  /* Only hidden decorations are released, least recently drawn first:
+   * nothing schedules a redraw of a visible one, so its title would
+   * disappear until it is damaged again */
+  const uint32_t now = wf::get_current_time();
+  for (auto it = lru.rbegin(); (it != lru.rend()) && (total > limit); ++it) {
+    std::unordered_set<const void *> shared;
+    if (!it->object->get_resident_bytes(shared) ||
+        it->object->is_visible() || (now - it->last_used < RECENTLY_USED)) {
+      continue;
+    }
+
+    /* Shared titles are only freed along with their last user, so the
+     * memory actually freed is found by counting again */
+    release(std::prev(it.base()));
+    total = get_resident_bytes();
+  }
+
+  if (total > limit) {
+    LOGD("gapsdecor: ", total, " bytes resident, over the budget of ", limit);
+  }
+}
+} // namespace decor
+} // namespace wf
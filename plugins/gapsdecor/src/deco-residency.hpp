@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_set>
+#include <unordered_map>
+
+#include <wayfire/option-wrapper.hpp>
+#include <wayfire/util.hpp>
+
+namespace wf {
+namespace decor {
+/**
+ * Something holding GPU memory which can be freed at any time and rebuilt
+ * lazily, the next time it is drawn.
+ */
+class resident_t {
+public:
+  virtual ~resident_t() = default;
+
+  /**
+   * @return The memory currently held, in bytes.
+   *
+   * @param shared Resources shared with other objects which were already
+   *   counted. Shared resources are only counted if they are not in it yet,
+   *   and are then added to it.
+   */
+  virtual size_t
+  get_resident_bytes(std::unordered_set<const void *> &shared) const = 0;
+
+  /** @return Whether the object can currently be seen on any output */
+  virtual bool is_visible() const = 0;
+
+  /** Free everything which can be rebuilt on the next frame */
+  virtual void release_resources() = 0;
+};
+
+/**
+ * Decides which decorations keep their textures.
+ *
+ * Decorations which have not been visible for gapsdecor/release_hidden_after
+ * milliseconds are released. On top of that, while the memory of all
+ * decorations exceeds gapsdecor/resident_budget, hidden decorations are
+ * released earlier, least recently drawn first. Visible decorations always
+ * keep their textures.
+ *
+ * A single instance is shared by all decorations, see
+ * wf::shared_data::ref_ptr_t.
+ */
+class residency_manager_t {
+public:
+  residency_manager_t() = default;
+  residency_manager_t(const residency_manager_t &) = delete;
+  residency_manager_t &operator=(const residency_manager_t &) = delete;
+
+  /** Mark @object as drawn just now, and start tracking it if needed */
+  void touch(resident_t *object);
+
+  /** Stop tracking @object. Must be called before it is destroyed. */
+  void remove(resident_t *object);
+
+  /** @return How many times a decoration's resources were released */
+  uint64_t get_releases() const { return releases; }
+
+  /**
+   * @return The memory held by all tracked decorations, in bytes. Resources
+   *   shared by several decorations are counted once.
+   */
+  size_t get_resident_bytes() const;
+
+private:
+  struct entry_t {
+    resident_t *object;
+    /* When the object was last drawn, in milliseconds */
+    uint32_t last_used;
+  };
+
+  /* Most recently drawn objects are in front */
+  std::list<entry_t> lru;
+  std::unordered_map<resident_t *, std::list<entry_t>::iterator> index;
+  uint64_t releases = 0;
+
+  wf::option_wrapper_t<int> budget{"gapsdecor/resident_budget"};
+  wf::option_wrapper_t<int> release_after{"gapsdecor/release_hidden_after"};
+
+  wf::wl_timer<true> sweep_timer;
+  wf::wl_idle_call idle_enforce;
+
+  /** Release objects which have been hidden for too long */
+  void sweep();
+  /** Release the least recently drawn objects until the budget is met */
+  void enforce_budget();
+  void release(std::list<entry_t>::iterator it);
+};
+} // namespace decor
+} // namespace wf
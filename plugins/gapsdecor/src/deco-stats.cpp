@@ -0,0 +1,41 @@
+#include "deco-stats.hpp"
+#include <algorithm>
+
+namespace wf {
+namespace decor {
+static double to_ms(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void timing_t::record(std::chrono::steady_clock::duration duration) {
+  std::lock_guard<std::mutex> lock(mutex);
+  ++count;
+  total += duration;
+  if (samples.size() < MAX_SAMPLES) {
+    samples.push_back(duration);
+  } else {
+    samples[next_sample] = duration;
+    next_sample = (next_sample + 1) % MAX_SAMPLES;
+  }
+}
+
+timing_t::summary_t timing_t::summarize() const {
+  std::vector<std::chrono::steady_clock::duration> sorted;
+  summary_t summary;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    summary.count = count;
+    summary.total_ms = to_ms(total);
+    sorted = samples;
+  }
+
+  if (!sorted.empty()) {
+    auto p99 = sorted.begin() + (sorted.size() - 1) * 99 / 100;
+    std::nth_element(sorted.begin(), p99, sorted.end());
+    summary.p99_ms = to_ms(*p99);
+  }
+
+  return summary;
+}
+} // namespace decor
+} // namespace wf
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace wf {
+namespace decor {
+/**
+ * Durations of one operation: their total, and the most recent samples to
+ * compute percentiles from. Safe to use from any thread.
+ */
+class timing_t {
+public:
+  struct summary_t {
+    uint64_t count = 0;
+    double total_ms = 0;
+    /* 99th percentile of the recent samples */
+    double p99_ms = 0;
+  };
+
+  void record(std::chrono::steady_clock::duration duration);
+  summary_t summarize() const;
+
+private:
+  static constexpr size_t MAX_SAMPLES = 1024;
+
+  mutable std::mutex mutex;
+  uint64_t count = 0;
+  std::chrono::steady_clock::duration total{0};
+  /* Ring buffer of the last MAX_SAMPLES durations */
+  std::vector<std::chrono::steady_clock::duration> samples;
+  size_t next_sample = 0;
+};
+
+/** Records the time until it goes out of scope into a timing_t */
+class scoped_timing_t {
+public:
+  scoped_timing_t(timing_t &timing)
+      : timing(timing), start(std::chrono::steady_clock::now()) {}
+  ~scoped_timing_t() {
+    timing.record(std::chrono::steady_clock::now() - start);
+  }
+
+  scoped_timing_t(const scoped_timing_t &) = delete;
+  scoped_timing_t &operator=(const scoped_timing_t &) = delete;
+
+private:
+  timing_t &timing;
+  std::chrono::steady_clock::time_point start;
+};
+
+/** Work done on behalf of decorations, either in total or for a single view */
+struct decoration_counters_t {
+  uint64_t title_rasterizations = 0;
+  uint64_t texture_uploads = 0;
+  uint64_t bytes_uploaded = 0;
+};
+
+/** What a single view's decoration did and holds */
+struct view_stats_t {
+  decoration_counters_t counters;
+  /* Title textures shown, which may be shared with other views */
+  size_t title_bytes = 0;
+  /* Composited titlebars, owned by the view */
+  size_t titlebar_bytes = 0;
+};
+
+/**
+ * Counters shared by all decorations, used to observe the cost of gapsdecor.
+ * Apart from the timings, they are only updated from the main thread.
+ */
+struct gapsdecor_stats_t {
+  /* Title changes which were folded into a later refresh */
+  uint64_t titles_coalesced = 0;
+  /* Times a decoration freed its textures, see residency_manager_t */
+  uint64_t decorations_released = 0;
+  /* Times a decoration was laid out again after a theme option changed */
+  uint64_t decorations_rethemed = 0;
+  /* Transactions scheduled to update decorations, where a batch over many
+   * views counts once, and updates which changed nothing and were skipped */
+  uint64_t transactions_scheduled = 0;
+  uint64_t transactions_skipped = 0;
+  /* First frames of decorations, and those which had no title to show yet */
+  uint64_t first_frames = 0;
+  uint64_t first_frames_without_title = 0;
+  /* Buttons drawn with cairo. They are shared by all decorations through
+   * button_atlas_t, so they are not attributed to views. */
+  uint64_t button_rasterizations = 0;
+  decoration_counters_t totals;
+
+  timing_t render_text;
+  timing_t get_button_surface;
+  timing_t render_scissor_box;
+  /* Rendering of a whole output frame, with all views and decorations */
+  timing_t frame;
+  /* Decorating all existing views when the plugin is loaded */
+  timing_t load;
+  /* From a view being mapped to the end of the next frame on its output */
+  timing_t map_to_first_frame;
+};
+
+/** @return The process-wide gapsdecor counters */
+inline gapsdecor_stats_t &global_stats() {
+  static gapsdecor_stats_t stats;
+  return stats;
+}
+} // namespace decor
+} // namespace wf
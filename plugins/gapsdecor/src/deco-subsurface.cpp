@@ -5,15 +5,24 @@
 #include "wayfire/scene.hpp"
 #include "wayfire/signal-provider.hpp"
 #include "wayfire/toplevel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
 #include <memory>
+#include <set>
 #define GLM_FORCE_RADIANS
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <linux/input-event-codes.h>
 
 #include "deco-layout.hpp"
+#include "deco-painter.hpp"
+#include "deco-residency.hpp"
+#include "deco-stats.hpp"
 #include "deco-subsurface.hpp"
+#include "deco-theme-registry.hpp"
 #include "deco-theme.hpp"
+#include "deco-title-cache.hpp"
 #include <wayfire/core.hpp>
 #include <wayfire/nonstd/wlroots.hpp>
 #include <wayfire/opengl.hpp>
@@ -22,45 +31,207 @@
 #include <wayfire/toplevel-view.hpp>
 #include <wayfire/view-transform.hpp>
 #include <wayfire/window-manager.hpp>
+#include <wayfire/workspace-set.hpp>
 
 #include <wayfire/plugins/common/cairo-util.hpp>
+#include <wayfire/plugins/common/shared-core-data.hpp>
 
 #include <cairo.h>
 
 class simple_gapsdecor_node_t : public wf::scene::node_t,
                                 public wf::pointer_interaction_t,
-                                public wf::touch_interaction_t {
+                                public wf::touch_interaction_t,
+                                public wf::decor::resident_t {
   std::weak_ptr<wf::toplevel_view_interface_t> _view;
   wf::signal::connection_t<wf::view_title_changed_signal> title_set =
-      [=](wf::view_title_changed_signal *ev) {
-        if (auto view = _view.lock()) {
-          view->damage();
-        }
-      };
+      [=](wf::view_title_changed_signal *ev) { handle_title_changed(); };
+
+  /* The title currently displayed, may lag behind the view's title */
+  std::string title;
+  /* When the displayed title was last refreshed, in milliseconds */
+  uint32_t last_title_refresh = 0;
+  /* Delays the refresh of titles which change too often */
+  wf::wl_timer<false> title_refresh_timer;
+  /* Number of title changes folded into a later refresh */
+  uint64_t titles_coalesced = 0;
+  wf::option_wrapper_t<int> title_max_fps{"gapsdecor/title_max_fps"};
+
+  /**
+   * Rate-limit title refreshes to gapsdecor/title_max_fps. Changes arriving
+   * faster than that are coalesced: only the latest title is shown once the
+   * interval has passed.
+   */
+  void handle_title_changed() {
+    if (title_refresh_timer.is_connected()) {
+      ++titles_coalesced;
+      ++wf::decor::global_stats().titles_coalesced;
+      return;
+    }
+
+    const int max_fps = title_max_fps;
+    const uint32_t interval = max_fps > 0 ? 1000 / max_fps : 0;
+    const uint32_t since_last = wf::get_current_time() - last_title_refresh;
+    if (since_last >= interval) {
+      refresh_title();
+      return;
+    }
 
-  void update_title(int width, int height, double scale) {
+    ++titles_coalesced;
+    ++wf::decor::global_stats().titles_coalesced;
+    title_refresh_timer.set_timeout(interval - since_last,
+                                    [=]() { refresh_title(); });
+  }
+
+  void refresh_title() {
     if (auto view = _view.lock()) {
-      int target_width = width * scale;
-      int target_height = height * scale;
-      if ((title_texture.tex.width != target_width) ||
-          (title_texture.tex.height != target_height) ||
-          (title_texture.current_text != view->get_title())) {
-        auto surface =
-            theme.render_text(view->get_title(), target_width, target_height);
-        cairo_surface_upload_to_texture(surface, title_texture.tex);
-        cairo_surface_destroy(surface);
-        title_texture.current_text = view->get_title();
+      last_title_refresh = wf::get_current_time();
+      if (title != view->get_title()) {
+        title = view->get_title();
+        damage_title();
+      }
+    }
+  }
+
+  /**
+   * Make sure the title texture for the given size is available or on its
+   * way. Never rasterizes: missing titles are produced in the background and
+   * until then, the last good texture stays on screen.
+   */
+  void request_title(int width, int height, double scale) {
+    wf::decor::title_key_t key{
+        .text = title,
+        .font = theme->get_font(),
+        .width = theme->has_resize_stable_title()
+                     ? wf::decor::gapsdecor_theme_t::TITLE_NATURAL_WIDTH
+                     : int(std::ceil(width * scale)),
+        .height = int(std::ceil(height * scale)),
+        .scale = scale,
+        .color = theme->get_title_color(),
+    };
+
+    auto &slot = titles[scale];
+    if (slot.texture && (slot.key == key)) {
+      slot.pending_key.reset();
+      return;
+    }
+
+    if (slot.pending_key == key) {
+      return;
+    }
+
+    std::weak_ptr<wf::scene::node_t> weak_self = weak_from_this();
+    auto texture = title_cache->acquire(
+        key,
+        [weak_self, key](wf::decor::title_cache_t::texture_ptr tex) {
+          if (auto self = weak_self.lock()) {
+            static_cast<simple_gapsdecor_node_t *>(self.get())
+                ->handle_title_ready(key, tex);
+          }
+        },
+        &slot.rasterizing);
+    if (slot.rasterizing) {
+      ++counters.title_rasterizations;
+    }
+
+    if (texture) {
+      slot.texture = texture;
+      slot.key = std::move(key);
+      slot.pending_key.reset();
+    } else {
+      slot.pending_key = std::move(key);
+    }
+  }
+
+  /** Request the titles of all title areas, at the given scale */
+  void request_titles(double scale) {
+    for (auto item : layout.get_renderable_areas()) {
+      if (item->get_type() == wf::decor::GAPSDECOR_AREA_TITLE) {
+        auto g = item->get_geometry();
+        request_title(g.width, g.height, scale);
+      }
+    }
+  }
+
+  void handle_title_ready(const wf::decor::title_key_t &key,
+                          wf::decor::title_cache_t::texture_ptr texture) {
+    auto it = titles.find(key.scale);
+    if ((it == titles.end()) || (it->second.pending_key != key)) {
+      /* Superseded by another title or size in the meantime, or the scale
+       * is no longer in use */
+      return;
+    }
+
+    if (it->second.rasterizing) {
+      ++counters.texture_uploads;
+      counters.bytes_uploaded += texture->bytes;
+    }
+
+    it->second.texture = texture;
+    it->second.key = key;
+    it->second.pending_key.reset();
+    it->second.rasterizing = false;
+    damage_title();
+  }
+
+  void damage_title() {
+    for (auto area : layout.get_renderable_areas()) {
+      if (area->get_type() == wf::decor::GAPSDECOR_AREA_TITLE) {
+        wf::scene::damage_node(shared_from_this(),
+                               area->get_geometry() + get_offset());
       }
     }
   }
 
-  struct {
-    wf::simple_texture_t tex;
-    std::string current_text = "";
-  } title_texture;
+  /* The title texture is shared with all other views showing the same title */
+  wf::shared_data::ref_ptr_t<wf::decor::title_cache_t> title_cache;
+
+  struct title_slot_t {
+    wf::decor::title_cache_t::texture_ptr texture;
+    wf::decor::title_key_t key;
+    /* The title which is being rasterized in the background, if any */
+    std::optional<wf::decor::title_key_t> pending_key;
+    /* Whether this view started the rasterization of the pending title */
+    bool rasterizing = false;
+  };
+
+  /* One title per output scale the view is shown at, so that views spanning
+   * outputs with different scales do not re-rasterize on every frame */
+  std::map<double, title_slot_t> titles;
+
+  /* Everything a composited titlebar depends on */
+  struct titlebar_state_t {
+    /* The key of the title drawn, not its texture: texture objects are
+     * reused for other titles by the cache */
+    std::optional<wf::decor::title_key_t> title;
+    bool activated;
+    int width, height;
+    wf::color_t background;
+
+    bool operator==(const titlebar_state_t &other) const {
+      return (title == other.title) && (activated == other.activated) &&
+             (width == other.width) && (height == other.height) &&
+             (background.r == other.background.r) &&
+             (background.g == other.background.g) &&
+             (background.b == other.background.b) &&
+             (background.a == other.background.a);
+    }
+  };
+
+  struct composited_titlebar_t {
+    wf::framebuffer_base_t buffer;
+    std::optional<titlebar_state_t> state;
+  };
+
+  /* Titlebars pre-composited at rest, per output scale, see
+   * gapsdecor/composite_titlebar */
+  std::map<double, composited_titlebar_t> titlebars;
 
 public:
-  wf::decor::gapsdecor_theme_t theme;
+  /* The themes are shared between all decorations with the same buttons */
+  wf::shared_data::ref_ptr_t<wf::decor::theme_registry_t> themes;
+  std::shared_ptr<wf::decor::gapsdecor_theme_t> theme;
+  /* The theme generation the layout was built for */
+  uint64_t theme_generation;
   wf::decor::gapsdecor_layout_t layout;
   wf::region_t cached_region;
 
@@ -70,56 +241,433 @@ public:
   int current_titlebar;
 
   simple_gapsdecor_node_t(wayfire_toplevel_view view)
-      : node_t(false), theme{},
-        layout{theme, [=](wlr_box box) {
+      : node_t(false), theme{themes->get_theme(get_buttons(view))},
+        theme_generation{themes->get_generation()},
+        layout{*theme, [=](wlr_box box) {
                  wf::scene::damage_node(shared_from_this(), box + get_offset());
                }} {
     this->_view = view->weak_from_this();
+    this->title = view->get_title();
     view->connect(&title_set);
+
+    // make sure to hide frame if the view is fullscreen
+    update_gapsdecor_size();
+    /* Tracked from the start, as warm_up() may build textures for a
+     * decoration which is never drawn */
+    residency->touch(this);
+  }
+
+  /** @return The buttons shown on the decoration of @view */
+  static wf::decor::button_type_t get_buttons(wayfire_toplevel_view view) {
     if (view->parent) {
-      theme.set_buttons(wf::decor::button_type_t(
-          wf::decor::BUTTON_TOGGLE_MAXIMIZE | wf::decor::BUTTON_CLOSE));
-    } else {
-      theme.set_buttons(wf::decor::button_type_t(
-          wf::decor::BUTTON_MINIMIZE | wf::decor::BUTTON_TOGGLE_MAXIMIZE |
-          wf::decor::BUTTON_CLOSE));
+      return wf::decor::button_type_t(wf::decor::BUTTON_TOGGLE_MAXIMIZE |
+                                      wf::decor::BUTTON_CLOSE);
     }
 
-    // make sure to hide frame if the view is fullscreen
+    return wf::decor::button_type_t(wf::decor::BUTTON_MINIMIZE |
+                                    wf::decor::BUTTON_TOGGLE_MAXIMIZE |
+                                    wf::decor::BUTTON_CLOSE);
+  }
+
+  /**
+   * Lay out the decoration again if the theme options changed since it was
+   * last laid out.
+   *
+   * @return Whether the size of the decoration changed, in which case the
+   *   margins of the view need to be updated. Otherwise, the decoration was
+   *   only damaged.
+   */
+  bool update_theme() {
+    if (theme_generation == themes->get_generation()) {
+      return false;
+    }
+
+    const int old_thickness = current_thickness;
+    const int old_titlebar = current_titlebar;
+    theme_generation = themes->get_generation();
+    ++wf::decor::global_stats().decorations_rethemed;
+    /* The titlebar looks different now, titles are found again by key */
+    release_titlebars();
+    layout.reload_theme();
     update_gapsdecor_size();
+    resize(size);
+    if (auto view = _view.lock(); view && view->get_output()) {
+      prepare_buttons(view->get_output()->handle->scale);
+    }
+
+    return (current_thickness != old_thickness) ||
+           (current_titlebar != old_titlebar);
+  }
+
+  /**
+   * Prepare what the first frame needs while the view is being mapped, so
+   * that the frame only has to composite: start rasterizing the titles in
+   * the background, and build the button images once the main loop is idle.
+   */
+  void warm_up() {
+    auto view = _view.lock();
+    if (!view || !view->get_output() ||
+        view->toplevel()->pending().fullscreen) {
+      return;
+    }
+
+    const double scale = view->get_output()->handle->scale;
+    request_titles(scale);
+    prepare_buttons(scale);
+  }
+
+  /**
+   * Build the button images for the given scale once the main loop is idle,
+   * outside of any render pass, and redraw the decoration with them.
+   */
+  void prepare_buttons(double scale) {
+    idle_warm_up.run_once([=]() {
+      painter.prepare(*theme, scale);
+      wf::scene::damage_node(shared_from_this(), get_bounding_box());
+    });
+  }
+
+  ~simple_gapsdecor_node_t() {
+    residency->remove(this);
+    release_titles();
+    release_titlebars();
+  }
+
+  /* Work done for this view only */
+  wf::decor::decoration_counters_t counters;
+
+  /** @return The size of the titles shown, which may be shared with others */
+  size_t get_title_bytes() const {
+    size_t bytes = 0;
+    for (const auto &[scale, slot] : titles) {
+      bytes += slot.texture ? slot.texture->bytes : 0;
+    }
+
+    return bytes;
+  }
+
+  /** @return The size of the composited titlebars, owned by this view */
+  size_t get_titlebar_bytes() const {
+    size_t bytes = 0;
+    for (const auto &[scale, titlebar] : titlebars) {
+      bytes += size_t(titlebar.buffer.viewport_width) *
+               titlebar.buffer.viewport_height * 4;
+    }
+
+    return bytes;
+  }
+
+  /* wf::decor::resident_t implementation */
+  size_t
+  get_resident_bytes(std::unordered_set<const void *> &shared) const override {
+    size_t bytes = get_titlebar_bytes();
+    for (const auto &[scale, slot] : titles) {
+      if (slot.texture && shared.insert(slot.texture.get()).second) {
+        bytes += slot.texture->bytes;
+      }
+    }
+
+    return bytes;
+  }
+
+  bool is_visible() const override {
+    auto view = _view.lock();
+    if (!view || !view->is_mapped() || !view->get_output() ||
+        view->toplevel()->current().fullscreen ||
+        !view->get_root_node()->is_enabled()) {
+      return false;
+    }
+
+    auto wset = view->get_output()->wset();
+    return wset->view_visible_on(nonstd::make_observer(view.get()),
+                                 wset->get_current_workspace());
+  }
+
+  void release_resources() override {
+    release_titles();
+    release_titlebars();
+    layout.release_resources();
   }
 
   wf::point_t get_offset() { return {-current_thickness, -current_titlebar}; }
 
-  void render_title(const wf::render_target_t &fb, wf::geometry_t geometry) {
-    update_title(geometry.width, geometry.height, fb.scale);
-    OpenGL::render_texture(title_texture.tex.tex, fb, geometry, glm::vec4(1.0f),
-                           OpenGL::TEXTURE_TRANSFORM_INVERT_Y);
+  /* Frees the textures of hidden decorations */
+  wf::shared_data::ref_ptr_t<wf::decor::residency_manager_t> residency;
+
+  /* Draws the decoration */
+  wf::decor::gl_painter_t painter;
+  wf::wl_idle_call idle_warm_up;
+  /* Whether the decoration has been drawn at least once */
+  bool first_frame_drawn = false;
+  /* Buttons to draw, reused between frames to avoid reallocating */
+  std::vector<wf::decor::button_instance_t> buttons;
+
+  /**
+   * Drop the titles of scales which are not in @scales, for ex. after an
+   * output was removed or its scale changed.
+   */
+  void prune_titles(const std::set<double> &scales) {
+    for (auto it = titles.begin(); it != titles.end();) {
+      if (scales.count(it->first)) {
+        ++it;
+      } else {
+        title_cache->release(it->second.key, it->second.texture);
+        it = titles.erase(it);
+      }
+    }
+
+    OpenGL::render_begin();
+    for (auto it = titlebars.begin(); it != titlebars.end();) {
+      if (scales.count(it->first)) {
+        ++it;
+      } else {
+        it->second.buffer.release();
+        it = titlebars.erase(it);
+      }
+    }
+
+    OpenGL::render_end();
+  }
+
+  /**
+   * Drop the titles, freeing their textures unless other views show them
+   * too. Titles still being rasterized are discarded once ready.
+   */
+  void release_titles() {
+    for (auto &[scale, slot] : titles) {
+      title_cache->release(slot.key, slot.texture);
+    }
+
+    titles.clear();
+  }
+
+  /** Free the composited titlebars, for ex. when the mode is turned off */
+  void release_titlebars() {
+    if (titlebars.empty()) {
+      return;
+    }
+
+    OpenGL::render_begin();
+    for (auto &[scale, titlebar] : titlebars) {
+      titlebar.buffer.release();
+    }
+
+    OpenGL::render_end();
+    titlebars.clear();
+  }
+
+  /** @return The titlebar and top border, relative to the view */
+  wf::geometry_t get_titlebar_geometry() {
+    return {0, 0, size.width, current_titlebar};
+  }
+
+  /**
+   * Composite the titlebar at rest for the given scale, unless it is already
+   * up to date. Must not be called between OpenGL::render_begin() and
+   * OpenGL::render_end().
+   */
+  void update_titlebar(double scale, bool activated) {
+    auto it = titles.find(scale);
+    titlebar_state_t state{
+        .title = ((it != titles.end()) && it->second.texture)
+                     ? std::optional{it->second.key}
+                     : std::nullopt,
+        .activated = activated,
+        .width = size.width,
+        .height = current_titlebar,
+        .background = theme->get_background_color(activated),
+    };
+
+    auto &titlebar = titlebars[scale];
+    if (titlebar.state == state) {
+      return;
+    }
+
+    titlebar.state = state;
+    auto strip = get_titlebar_geometry();
+    OpenGL::render_begin();
+    titlebar.buffer.allocate(std::max(1, int(std::ceil(strip.width * scale))),
+                             std::max(1, int(std::ceil(strip.height * scale))));
+    OpenGL::render_end();
+
+    wf::render_target_t target{titlebar.buffer};
+    target.geometry = strip;
+    target.scale = scale;
+
+    painter.begin(target);
+    OpenGL::clear({0, 0, 0, 0});
+    theme->render_background(target, strip, strip, activated);
+
+    buttons.clear();
+    for (auto item : layout.get_renderable_areas()) {
+      auto item_geometry = item->get_geometry();
+      if (item->get_type() == wf::decor::GAPSDECOR_AREA_TITLE) {
+        render_title(scale, item_geometry, strip);
+      } else {
+        buttons.push_back(item->as_button().describe(item_geometry, true));
+      }
+    }
+
+    painter.set_clip(strip);
+    painter.draw_buttons(buttons, *theme);
+    painter.end();
+  }
+
+  /**
+   * Draw the parts of the decoration within a single scissor box, using the
+   * composited titlebar. Only buttons which are not at rest are drawn on top.
+   * Must be called between painter.begin() and painter.end().
+   */
+  void render_composited_box(const wf::render_target_t &fb, wf::point_t origin,
+                             const wlr_box &scissor, bool activated) {
+    wf::decor::scoped_timing_t timing{
+        wf::decor::global_stats().render_scissor_box};
+    auto strip = get_titlebar_geometry() + origin;
+    wlr_box rest{origin.x, origin.y + strip.height, size.width,
+                 size.height - strip.height};
+    if (rest & scissor) {
+      theme->render_background(
+          fb, rest, wf::geometry_intersection(scissor, rest), activated);
+    }
+
+    if (!(strip & scissor)) {
+      return;
+    }
+
+    painter.set_clip(wf::geometry_intersection(scissor, strip));
+    painter.draw_texture(titlebars[fb.scale].buffer.tex, strip);
+
+    buttons.clear();
+    for (auto item : layout.get_renderable_areas()) {
+      auto item_geometry = item->get_geometry() + origin;
+      if ((item->get_type() == wf::decor::GAPSDECOR_AREA_BUTTON) &&
+          !item->as_button().is_idle() && (item_geometry & scissor)) {
+        buttons.push_back(item->as_button().describe(item_geometry));
+      }
+    }
+
+    painter.set_clip(scissor);
+    painter.draw_buttons(buttons, *theme);
+  }
+
+  /** @return Whether the decoration fully covers what is below it */
+  bool is_opaque() {
+    if (auto view = _view.lock()) {
+      return theme->is_background_opaque(view->activated);
+    }
+
+    return false;
   }
 
+  void render_title(double scale, wf::geometry_t geometry,
+                    const wf::geometry_t &scissor) {
+    auto it = titles.find(scale);
+    if ((it == titles.end()) || !it->second.texture) {
+      return;
+    }
+
+    const auto &title_texture = it->second.texture;
+    const auto &title_key = it->second.key;
+    auto clip = scissor;
+    if (title_key.width == wf::decor::gapsdecor_theme_t::TITLE_NATURAL_WIDTH) {
+      /* The texture has the width of the text: draw it unscaled and cut off
+       * whatever does not fit in the titlebar. Resizing the view thus never
+       * needs a new texture. */
+      clip = wf::geometry_intersection(scissor, geometry);
+      geometry.width = std::ceil(title_texture->tex.width / title_key.scale);
+    }
+
+    painter.set_clip(clip);
+    painter.draw_title(title_texture->tex, geometry);
+  }
+
+  /**
+   * Draw the parts of the decoration within a single scissor box.
+   * Must be called between painter.begin() and painter.end().
+   */
   void render_scissor_box(const wf::render_target_t &fb, wf::point_t origin,
-                          const wlr_box &scissor) {
+                          const wlr_box &scissor, bool activated) {
+    wf::decor::scoped_timing_t timing{
+        wf::decor::global_stats().render_scissor_box};
     /* Clear background */
     wlr_box geometry{origin.x, origin.y, size.width, size.height};
+    theme->render_background(fb, geometry, scissor, activated);
+
+    /* Draw title & buttons, skipping those outside of the box */
+    buttons.clear();
+    for (auto item : layout.get_renderable_areas()) {
+      auto item_geometry = item->get_geometry() + origin;
+      if (!(item_geometry & scissor)) {
+        continue;
+      }
+
+      if (item->get_type() == wf::decor::GAPSDECOR_AREA_TITLE) {
+        render_title(fb.scale, item_geometry, scissor);
+      } else {
+        buttons.push_back(item->as_button().describe(item_geometry));
+      }
+    }
+
+    painter.set_clip(scissor);
+    painter.draw_buttons(buttons, *theme);
+  }
+
+  /**
+   * Draw the decoration in the given region, in a single GL pass.
+   * Every damage box keeps its own scissor, so pixels outside of the damage
+   * are never blended twice.
+   */
+  void render_region(const wf::render_target_t &fb,
+                     const wf::region_t &region) {
+    const auto origin = get_offset();
+    residency->touch(this);
+    request_titles(fb.scale);
+    if (!first_frame_drawn) {
+      first_frame_drawn = true;
+      auto &stats = wf::decor::global_stats();
+      ++stats.first_frames;
+      auto it = titles.find(fb.scale);
+      if ((it == titles.end()) || !it->second.texture) {
+        ++stats.first_frames_without_title;
+      }
+    }
 
     bool activated = false;
     if (auto view = _view.lock()) {
       activated = view->activated;
     }
 
-    theme.render_background(fb, geometry, scissor, activated);
+    /* Buttons are not drawn until their images exist, so do not composite a
+     * titlebar without them */
+    const bool buttons_ready = painter.is_prepared(*theme, fb.scale);
+    if (!buttons_ready) {
+      prepare_buttons(fb.scale);
+    }
 
-    /* Draw title & buttons */
-    auto renderables = layout.get_renderable_areas();
-    for (auto item : renderables) {
-      if (item->get_type() == wf::decor::GAPSDECOR_AREA_TITLE) {
-        OpenGL::render_begin(fb);
-        fb.logic_scissor(scissor);
-        render_title(fb, item->get_geometry() + origin);
-        OpenGL::render_end();
-      } else // button
-      {
-        item->as_button().render(fb, item->get_geometry() + origin, scissor);
+    const bool composited = theme->has_composited_titlebar() &&
+                            (current_titlebar > 0) && buttons_ready;
+    if (composited) {
+      update_titlebar(fb.scale, activated);
+    } else {
+      release_titlebars();
+    }
+
+    painter.begin(fb);
+    for (const auto &box : region) {
+      if (composited) {
+        render_composited_box(fb, origin, wlr_box_from_pixman_box(box),
+                              activated);
+      } else {
+        render_scissor_box(fb, origin, wlr_box_from_pixman_box(box),
+                           activated);
+      }
+    }
+
+    painter.end();
+
+    for (auto item : layout.get_renderable_areas()) {
+      if (item->get_type() == wf::decor::GAPSDECOR_AREA_BUTTON) {
+        item->as_button().continue_animation();
       }
     }
   }
@@ -152,11 +700,19 @@ public:
 
   public:
     gapsdecor_render_instance_t(simple_gapsdecor_node_t *self,
-                                wf::scene::damage_callback push_damage) {
+                                wf::scene::damage_callback push_damage,
+                                wf::output_t *output) {
       this->self = std::dynamic_pointer_cast<simple_gapsdecor_node_t>(
           self->shared_from_this());
       this->push_damage = push_damage;
       self->connect(&on_surface_damage);
+
+      if (output) {
+        /* Start rasterizing the title and building the buttons for this
+         * output's scale right away, instead of waiting for the first frame */
+        self->request_titles(output->handle->scale);
+        self->prepare_buttons(output->handle->scale);
+      }
     }
 
     void schedule_instructions(
@@ -171,14 +727,17 @@ public:
             .damage = std::move(our_damage),
         });
       }
+
+      if (self->is_opaque()) {
+        /* Nothing below a solid decoration is visible, so it does not need
+         * to be repainted */
+        damage ^= our_region;
+      }
     }
 
     void render(const wf::render_target_t &target,
                 const wf::region_t &region) override {
-      for (const auto &box : region) {
-        self->render_scissor_box(target, self->get_offset(),
-                                 wlr_box_from_pixman_box(box));
-      }
+      self->render_region(target, region);
     }
   };
 
@@ -186,8 +745,8 @@ public:
   gen_render_instances(std::vector<wf::scene::render_instance_uptr> &instances,
                        wf::scene::damage_callback push_damage,
                        wf::output_t *output = nullptr) override {
-    instances.push_back(
-        std::make_unique<gapsdecor_render_instance_t>(this, push_damage));
+    instances.push_back(std::make_unique<gapsdecor_render_instance_t>(
+        this, push_damage, output));
   }
 
   wf::geometry_t get_bounding_box() override {
@@ -285,9 +844,11 @@ public:
       current_thickness = 0;
       current_titlebar = 0;
       this->cached_region.clear();
+      /* Nothing is drawn, rebuilt once the view leaves fullscreen */
+      release_resources();
     } else {
-      current_thickness = theme.get_border_size();
-      current_titlebar = theme.get_title_height() + theme.get_border_size();
+      current_thickness = theme->get_border_size();
+      current_titlebar = theme->get_title_height() + theme->get_border_size();
       this->cached_region = layout.calculate_region();
     }
   }
@@ -297,6 +858,7 @@ wf::simple_decorator_t::simple_decorator_t(wayfire_toplevel_view view) {
   this->view = view;
   deco = std::make_shared<simple_gapsdecor_node_t>(view);
   deco->resize(wf::dimensions(view->get_pending_geometry()));
+  deco->warm_up();
   wf::scene::add_back(view->get_surface_root_node(), deco);
 
   view->connect(&on_view_activated);
@@ -308,7 +870,14 @@ wf::simple_decorator_t::simple_decorator_t(wayfire_toplevel_view view) {
   };
 
   on_view_geometry_changed = [this](auto) {
-    deco->resize(wf::dimensions(this->view->get_geometry()));
+    auto dims = wf::dimensions(this->view->get_geometry());
+    if (dims == deco->size) {
+      /* Only moved: the decoration is positioned relative to the view, so
+       * there is nothing to lay out or damage */
+      return;
+    }
+
+    deco->resize(dims);
   };
 
   on_view_fullscreen = [this](auto) {
@@ -321,15 +890,30 @@ wf::simple_decorator_t::simple_decorator_t(wayfire_toplevel_view view) {
 
 wf::simple_decorator_t::~simple_decorator_t() { wf::scene::remove_child(deco); }
 
+wf::decor::view_stats_t wf::simple_decorator_t::get_stats() const {
+  return {
+      .counters = deco->counters,
+      .title_bytes = deco->get_title_bytes(),
+      .titlebar_bytes = deco->get_titlebar_bytes(),
+  };
+}
+
+void wf::simple_decorator_t::prune_title_scales(
+    const std::set<double> &scales) {
+  deco->prune_titles(scales);
+}
+
+bool wf::simple_decorator_t::update_theme() { return deco->update_theme(); }
+
 wf::decoration_margins_t
 wf::simple_decorator_t::get_margins(const wf::toplevel_state_t &state) {
   if (state.fullscreen) {
     return {0, 0, 0, 0};
   }
 
-  const int thickness = deco->theme.get_border_size();
+  const int thickness = deco->theme->get_border_size();
   const int titlebar =
-      deco->theme.get_title_height() + deco->theme.get_border_size();
+      deco->theme->get_title_height() + deco->theme->get_border_size();
   return wf::decoration_margins_t{
       .left = thickness,
       .right = thickness,
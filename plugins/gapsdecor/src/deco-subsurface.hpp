@@ -1,8 +1,10 @@
 #ifndef DECO_SUBSURFACE_HPP
 #define DECO_SUBSURFACE_HPP
 
+#include "deco-stats.hpp"
 #include "wayfire/object.hpp"
 #include "wayfire/toplevel.hpp"
+#include <set>
 #include <wayfire/signal-definitions.hpp>
 #include <wayfire/toplevel-view.hpp>
 
@@ -24,6 +26,18 @@ public:
   simple_decorator_t(wayfire_toplevel_view view);
   ~simple_decorator_t();
   wf::decoration_margins_t get_margins(const wf::toplevel_state_t &state);
+
+  /** @return The counters and memory of this view's decoration */
+  wf::decor::view_stats_t get_stats() const;
+
+  /** Release title textures for output scales which are not in @scales */
+  void prune_title_scales(const std::set<double> &scales);
+
+  /**
+   * Lay out the decoration again if the theme changed.
+   * @return Whether the margins of the view changed.
+   */
+  bool update_theme();
 };
 } // namespace wf
 
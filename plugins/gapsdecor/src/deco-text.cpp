@@ -0,0 +1,71 @@
+#include "deco-text.hpp"
+#include <algorithm>
+
+namespace wf {
+namespace decor {
+text_renderer_t::text_renderer_t() {
+  /* All titles are drawn on image surfaces with an identity transform, so
+   * the context can be set up once for all of them. */
+  measure_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+  measure_cr = cairo_create(measure_surface);
+  context = pango_cairo_create_context(measure_cr);
+  layout = pango_layout_new(context);
+}
+
+text_renderer_t::~text_renderer_t() {
+  if (font_desc) {
+    pango_font_description_free(font_desc);
+  }
+
+  g_object_unref(layout);
+  g_object_unref(context);
+  cairo_destroy(measure_cr);
+  cairo_surface_destroy(measure_surface);
+}
+
+void text_renderer_t::set_font(const std::string &font, double size) {
+  if (!font_desc || (font != current_font)) {
+    if (font_desc) {
+      pango_font_description_free(font_desc);
+    }
+
+    font_desc = pango_font_description_from_string(font.c_str());
+    current_font = font;
+    current_size = -1;
+  }
+
+  if (size != current_size) {
+    pango_font_description_set_absolute_size(font_desc, size * PANGO_SCALE);
+    pango_layout_set_font_description(layout, font_desc);
+    current_size = size;
+  }
+}
+
+cairo_surface_t *text_renderer_t::render(const std::string &text,
+                                         const std::string &font,
+                                         wf::color_t color, int width,
+                                         int height) {
+  const auto format = CAIRO_FORMAT_ARGB32;
+  if (height == 0) {
+    return cairo_image_surface_create(format, std::max(width, 0), height);
+  }
+
+  const float font_scale = 0.8;
+  set_font(font, height * font_scale);
+  pango_layout_set_text(layout, text.c_str(), text.size());
+
+  if (width == NATURAL_WIDTH) {
+    pango_layout_get_pixel_size(layout, &width, nullptr);
+    width = std::clamp(width, 1, MAX_WIDTH);
+  }
+
+  auto surface = cairo_image_surface_create(format, width, height);
+  auto cr = cairo_create(surface);
+  cairo_set_source_rgba(cr, color.r, color.g, color.b, color.a);
+  pango_cairo_show_layout(cr, layout);
+  cairo_destroy(cr);
+
+  return surface;
+}
+} // namespace decor
+} // namespace wf
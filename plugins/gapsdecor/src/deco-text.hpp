@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+
+#include <cairo.h>
+#include <pango/pangocairo.h>
+#include <wayfire/config/types.hpp>
+
+namespace wf {
+namespace decor {
+/**
+ * Renders titles with pango.
+ *
+ * Parsing the font description and setting up a pango context and layout is
+ * a large part of the cost of rendering a short title, so these are kept
+ * between calls and only rebuilt when the font changes.
+ *
+ * Pango objects may not be shared between threads: each thread needs its own
+ * renderer.
+ */
+class text_renderer_t {
+public:
+  /** Width argument for render() to size the surface to the text */
+  static constexpr int NATURAL_WIDTH = -1;
+  /** Upper bound for the width of naturally sized text, in pixels */
+  static constexpr int MAX_WIDTH = 4096;
+
+  text_renderer_t();
+  ~text_renderer_t();
+  text_renderer_t(const text_renderer_t &) = delete;
+  text_renderer_t &operator=(const text_renderer_t &) = delete;
+
+  /**
+   * Render the given text on a new cairo_surface_t with the given size.
+   * The caller is responsible for freeing the memory afterwards.
+   *
+   * @param width The surface width, or NATURAL_WIDTH to fit the text.
+   * @param height The surface height. The font size is derived from it.
+   */
+  cairo_surface_t *render(const std::string &text, const std::string &font,
+                          wf::color_t color, int width, int height);
+
+private:
+  /* Used only to set up the pango context for image surfaces */
+  cairo_surface_t *measure_surface;
+  cairo_t *measure_cr;
+  PangoContext *context;
+  PangoLayout *layout;
+
+  PangoFontDescription *font_desc = nullptr;
+  std::string current_font;
+  double current_size = -1;
+
+  /** Update the layout's font, if @font or @size differ from the last call */
+  void set_font(const std::string &font, double size);
+};
+} // namespace decor
+} // namespace wf
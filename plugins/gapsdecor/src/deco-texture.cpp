@@ -0,0 +1,47 @@
+#include "deco-texture.hpp"
+#include "deco-stats.hpp"
+#include <wayfire/opengl.hpp>
+
+namespace wf {
+namespace decor {
+size_t upload_surface_to_texture(cairo_surface_t *surface,
+                                 wf::simple_texture_t &buffer) {
+  cairo_surface_flush(surface);
+  const int width = cairo_image_surface_get_width(surface);
+  const int height = cairo_image_surface_get_height(surface);
+  auto src = cairo_image_surface_get_data(surface);
+  auto &totals = global_stats().totals;
+  ++totals.texture_uploads;
+  totals.bytes_uploaded += (size_t)width * height * 4;
+
+  if ((buffer.tex != (GLuint)-1) && (buffer.width == width) &&
+      (buffer.height == height)) {
+    /* Same size: keep the storage, only replace the pixels */
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, buffer.tex));
+    GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA,
+                            GL_UNSIGNED_BYTE, src));
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+    return (size_t)width * height * 4;
+  }
+
+  buffer.width = width;
+  buffer.height = height;
+  if (buffer.tex == (GLuint)-1) {
+    GL_CALL(glGenTextures(1, &buffer.tex));
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, buffer.tex));
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    /* cairo stores pixels as BGRA on little-endian machines */
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE));
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED));
+  } else {
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, buffer.tex));
+  }
+
+  GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA,
+                       GL_UNSIGNED_BYTE, src));
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+  return (size_t)width * height * 4;
+}
+} // namespace decor
+} // namespace wf
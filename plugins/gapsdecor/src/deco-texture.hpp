@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cairo.h>
+#include <wayfire/plugins/common/simple-texture.hpp>
+
+namespace wf {
+namespace decor {
+/**
+ * Upload the contents of @surface to @buffer.
+ *
+ * Unlike cairo_surface_upload_to_texture(), an existing texture of the same
+ * size is updated in place instead of being reallocated. The GL context must
+ * be current.
+ *
+ * @return The number of bytes uploaded.
+ */
+size_t upload_surface_to_texture(cairo_surface_t *surface,
+                                 wf::simple_texture_t &buffer);
+} // namespace decor
+} // namespace wf
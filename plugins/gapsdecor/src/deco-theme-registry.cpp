@@ -0,0 +1,71 @@
+#include "deco-theme-registry.hpp"
+
+namespace wf {
+namespace decor {
+theme_registry_t::theme_registry_t() {
+  auto callback = [=]() { handle_option_changed(); };
+  font.set_callback(callback);
+  title_height.set_callback(callback);
+  border_size.set_callback(callback);
+  active_color.set_callback(callback);
+  inactive_color.set_callback(callback);
+  resize_stable_title.set_callback(callback);
+  shader_buttons.set_callback(callback);
+  composite_titlebar.set_callback(callback);
+  button_order.set_callback(callback);
+  options = read_options();
+}
+
+std::shared_ptr<gapsdecor_theme_t>
+theme_registry_t::get_theme(button_type_t buttons) {
+  auto &slot = themes[buttons];
+  if (auto theme = slot.lock()) {
+    return theme;
+  }
+
+  auto theme = std::make_shared<gapsdecor_theme_t>(options);
+  theme->set_buttons(buttons);
+  slot = theme;
+  return theme;
+}
+
+size_t theme_registry_t::get_theme_count() const {
+  size_t count = 0;
+  for (const auto &[buttons, theme] : themes) {
+    count += !theme.expired();
+  }
+
+  return count;
+}
+
+theme_options_t theme_registry_t::read_options() const {
+  return theme_options_t{
+      .font = font,
+      .title_height = title_height,
+      .border_size = border_size,
+      .active_color = active_color,
+      .inactive_color = inactive_color,
+      .resize_stable_title = resize_stable_title,
+      .shader_buttons = shader_buttons,
+      .composite_titlebar = composite_titlebar,
+      .button_order = button_order,
+  };
+}
+
+void theme_registry_t::handle_option_changed() {
+  idle_changed.run_once([=]() {
+    ++generation;
+    options = read_options();
+    for (const auto &[buttons, slot] : themes) {
+      if (auto theme = slot.lock()) {
+        theme->set_options(options);
+      }
+    }
+
+    theme_changed_signal data;
+    data.generation = generation;
+    this->emit(&data);
+  });
+}
+} // namespace decor
+} // namespace wf
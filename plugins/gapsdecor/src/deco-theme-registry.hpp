@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+
+#include "deco-theme.hpp"
+#include <wayfire/option-wrapper.hpp>
+#include <wayfire/signal-provider.hpp>
+#include <wayfire/util.hpp>
+
+namespace wf {
+namespace decor {
+/**
+ * on: theme_registry_t
+ * when: Once after one or more theme options changed. Decorations built
+ *   for an older generation must be laid out again.
+ */
+struct theme_changed_signal {
+  uint64_t generation;
+};
+
+/**
+ * The themes of all decorations. Decorations with the same set of buttons
+ * share a single theme, which lives as long as one of them uses it.
+ *
+ * The themes take their values from a snapshot of the options, taken once
+ * per generation. Changes of the options made together, for ex. by
+ * reloading the config file, are folded into a single new generation once
+ * the main loop goes idle. All themes switch to it at once, right before
+ * theme_changed_signal is emitted, so that no decoration sees new sizes
+ * before it is laid out again.
+ *
+ * A single instance is shared by all decorations, see
+ * wf::shared_data::ref_ptr_t.
+ */
+class theme_registry_t : public wf::signal::provider_t {
+public:
+  theme_registry_t();
+  theme_registry_t(const theme_registry_t &) = delete;
+  theme_registry_t &operator=(const theme_registry_t &) = delete;
+
+  /** @return The theme for decorations with the given buttons */
+  std::shared_ptr<gapsdecor_theme_t> get_theme(button_type_t buttons);
+
+  /** @return The current generation of the themes */
+  uint64_t get_generation() const { return generation; }
+
+  /** @return The number of themes currently in use */
+  size_t get_theme_count() const;
+
+private:
+  std::map<button_type_t, std::weak_ptr<gapsdecor_theme_t>> themes;
+  uint64_t generation = 0;
+  /* The options of the current generation */
+  theme_options_t options;
+  wf::wl_idle_call idle_changed;
+
+  void handle_option_changed();
+  /** @return The current values of the options */
+  theme_options_t read_options() const;
+
+  wf::option_wrapper_t<std::string> font{"gapsdecor/font"};
+  wf::option_wrapper_t<int> title_height{"gapsdecor/title_height"};
+  wf::option_wrapper_t<int> border_size{"gapsdecor/border_size"};
+  wf::option_wrapper_t<wf::color_t> active_color{"gapsdecor/active_color"};
+  wf::option_wrapper_t<wf::color_t> inactive_color{
+      "gapsdecor/inactive_color"};
+  wf::option_wrapper_t<bool> resize_stable_title{
+      "gapsdecor/resize_stable_title"};
+  wf::option_wrapper_t<bool> shader_buttons{"gapsdecor/shader_buttons"};
+  wf::option_wrapper_t<bool> composite_titlebar{
+      "gapsdecor/composite_titlebar"};
+  wf::option_wrapper_t<std::string> button_order{"gapsdecor/button_order"};
+};
+} // namespace decor
+} // namespace wf
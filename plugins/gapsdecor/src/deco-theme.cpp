@@ -1,20 +1,50 @@
 #include "deco-theme.hpp"
+#include "deco-stats.hpp"
+#include "deco-text.hpp"
+#include <algorithm>
+#include <cmath>
 #include <wayfire/core.hpp>
 #include <wayfire/opengl.hpp>
 #include <wayfire/render-manager.hpp>
 
 namespace wf {
 namespace decor {
-/** Create a new theme with the default parameters */
-gapsdecor_theme_t::gapsdecor_theme_t() {}
+/** Create a new theme with the given parameters */
+gapsdecor_theme_t::gapsdecor_theme_t(const theme_options_t &options)
+    : options(options) {}
+
+/** Replace the parameters, for ex. after the options changed */
+void gapsdecor_theme_t::set_options(const theme_options_t &options) {
+  this->options = options;
+}
 
 /** @return The available height for displaying the title */
-int gapsdecor_theme_t::get_title_height() const { return title_height; }
+int gapsdecor_theme_t::get_title_height() const {
+  return options.title_height;
+}
 
 /** @return The available border for resizing */
-int gapsdecor_theme_t::get_border_size() const { return border_size; }
+int gapsdecor_theme_t::get_border_size() const {
+  return options.border_size;
+}
 
-/** @return The available border for resizing */
+/** @return The font used for the title */
+std::string gapsdecor_theme_t::get_font() const { return options.font; }
+
+/** @return The color used for the title text */
+wf::color_t gapsdecor_theme_t::get_title_color() const { return {1, 1, 1, 1}; }
+
+/** @return Whether titles are rasterized independently of their width */
+bool gapsdecor_theme_t::has_resize_stable_title() const {
+  return options.resize_stable_title;
+}
+
+/** @return The names of the buttons, from left to right */
+std::string gapsdecor_theme_t::get_button_order() const {
+  return options.button_order;
+}
+
+/** Set the flags for buttons */
 void gapsdecor_theme_t::set_buttons(button_type_t flags) {
   button_flags = flags;
 }
@@ -22,7 +52,9 @@ void gapsdecor_theme_t::set_buttons(button_type_t flags) {
 /**
  * Fill the given rectangle with the background color(s).
  *
- * @param fb The target framebuffer, must have been bound already
+ * Must be called between OpenGL::render_begin(fb) and OpenGL::render_end().
+ *
+ * @param fb The target framebuffer
  * @param rectangle The rectangle to redraw.
  * @param scissor The GL scissor rectangle to use.
  * @param active Whether to use active or inactive colors
@@ -30,7 +62,24 @@ void gapsdecor_theme_t::set_buttons(button_type_t flags) {
 void gapsdecor_theme_t::render_background(const wf::render_target_t &fb,
                                           wf::geometry_t rectangle,
                                           const wf::geometry_t &scissor,
-                                          bool active) const {}
+                                          bool active) const {
+  /* A flat fill: the background is a single quad, with no texture to
+   * rasterize or upload */
+  /* render_rectangle() premultiplies the color itself */
+  fb.logic_scissor(scissor);
+  OpenGL::render_rectangle(rectangle, get_background_color(active),
+                           fb.get_orthographic_projection());
+}
+
+/** @return The background color for an active or inactive view */
+wf::color_t gapsdecor_theme_t::get_background_color(bool active) const {
+  return active ? options.active_color : options.inactive_color;
+}
+
+/** @return Whether the background fully hides what is behind it */
+bool gapsdecor_theme_t::is_background_opaque(bool active) const {
+  return get_background_color(active).a >= 1.0;
+}
 
 /**
  * Render the given text on a cairo_surface_t with the given size.
@@ -38,40 +87,87 @@ void gapsdecor_theme_t::render_background(const wf::render_target_t &fb,
  */
 cairo_surface_t *gapsdecor_theme_t::render_text(std::string text, int width,
                                                 int height) const {
-  const auto format = CAIRO_FORMAT_ARGB32;
-  auto surface = cairo_image_surface_create(format, width, height);
+  return render_text(text, get_font(), get_title_color(), width, height);
+}
+
+/**
+ * Same as render_text(), but with the font and color given explicitly.
+ * Does not access any options, so it is safe to call from any thread.
+ */
+cairo_surface_t *gapsdecor_theme_t::render_text(const std::string &text,
+                                                const std::string &font,
+                                                wf::color_t color, int width,
+                                                int height) {
+  scoped_timing_t timing{global_stats().render_text};
+  /* Pango objects cannot be shared between threads */
+  thread_local text_renderer_t renderer;
+  return renderer.render(text, font, color, width, height);
+}
 
-  if (height == 0) {
-    return surface;
+wf::color_t gapsdecor_theme_t::get_button_hover_color(button_type_t button) {
+  switch (button) {
+  case BUTTON_CLOSE:
+    return {242.0 / 255.0, 80.0 / 255.0, 86.0 / 255.0, 0.63};
+
+  case BUTTON_TOGGLE_MAXIMIZE:
+    return {57.0 / 255.0, 234.0 / 255.0, 73.0 / 255.0, 0.63};
+
+  case BUTTON_MINIMIZE:
+    return {250.0 / 255.0, 198.0 / 255.0, 54.0 / 255.0, 0.63};
+
+  default:
+    assert(false);
   }
 
-  auto cr = cairo_create(surface);
+  return {0, 0, 0, 0};
+}
 
-  const float font_scale = 0.8;
-  const float font_size = height * font_scale;
+/** @return Whether buttons are drawn with shaders instead of cairo */
+bool gapsdecor_theme_t::has_shader_buttons() const {
+  return options.shader_buttons;
+}
 
-  PangoFontDescription *font_desc;
-  PangoLayout *layout;
+/** @return Whether the titlebar is pre-composited into a single texture */
+bool gapsdecor_theme_t::has_composited_titlebar() const {
+  return options.composite_titlebar;
+}
 
-  // render text
-  font_desc = pango_font_description_from_string(((std::string)font).c_str());
-  pango_font_description_set_absolute_size(font_desc, font_size * PANGO_SCALE);
+/** @return The width of button outlines, relative to the button size */
+button_colors_t
+gapsdecor_theme_t::get_button_colors(button_type_t button,
+                                     double hover_progress) {
+  /** A gray that looks good on light and dark themes */
+  color_t base = {0.60, 0.60, 0.63, 0.36};
 
-  layout = pango_cairo_create_layout(cr);
-  pango_layout_set_font_description(layout, font_desc);
-  pango_layout_set_text(layout, text.c_str(), text.size());
-  cairo_set_source_rgba(cr, 1, 1, 1, 1);
-  pango_cairo_show_layout(cr, layout);
-  pango_font_description_free(font_desc);
-  g_object_unref(layout);
-  cairo_destroy(cr);
+  /**
+   * We just need the alpha component.
+   * r == g == b == 0.0 will be directly set
+   */
+  double line = 0.27;
+  double hover = 0.27;
 
-  return surface;
+  /** Coloured base on hover/press. Don't compare float to 0 */
+  if (fabs(hover_progress) > 1e-3) {
+    base = get_button_hover_color(button);
+    line *= 2.0;
+  }
+
+  /* The base is more opaque the further the hover animation went */
+  base.a = std::clamp(base.a + hover * hover_progress, 0.0, 1.0);
+  return {base, {0.0, 0.0, 0.0, line}};
+}
+
+double gapsdecor_theme_t::get_button_stroke() const {
+  /* Buttons are drawn as if rendered at the full titlebar height, with a
+   * one pixel border */
+  return 1.0 / std::max(1, get_title_height());
 }
 
 cairo_surface_t *
 gapsdecor_theme_t::get_button_surface(button_type_t button,
                                       const button_state_t &state) const {
+  scoped_timing_t timing{global_stats().get_button_surface};
+  ++global_stats().button_rasterizations;
   cairo_surface_t *button_surface = cairo_image_surface_create(
       CAIRO_FORMAT_ARGB32, state.width, state.height);
 
@@ -85,45 +181,28 @@ gapsdecor_theme_t::get_button_surface(button_type_t button,
   cairo_fill(cr);
 
   cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+  const auto colors = get_button_colors(button, state.hover_progress);
 
-  /** A gray that looks good on light and dark themes */
-  color_t base = {0.60, 0.60, 0.63, 0.36};
-
-  /**
-   * We just need the alpha component.
-   * r == g == b == 0.0 will be directly set
-   */
-  double line = 0.27;
-  double hover = 0.27;
-
-  /** Coloured base on hover/press. Don't compare float to 0 */
-  if (fabs(state.hover_progress) > 1e-3) {
-    switch (button) {
-    case BUTTON_CLOSE:
-      base = {242.0 / 255.0, 80.0 / 255.0, 86.0 / 255.0, 0.63};
-      break;
-
-    case BUTTON_TOGGLE_MAXIMIZE:
-      base = {57.0 / 255.0, 234.0 / 255.0, 73.0 / 255.0, 0.63};
-      break;
-
-    case BUTTON_MINIMIZE:
-      base = {250.0 / 255.0, 198.0 / 255.0, 54.0 / 255.0, 0.63};
-      break;
-
-    default:
-      assert(false);
-    }
-
-    line *= 2.0;
-  }
+  /* Draw the base */
+  cairo_set_source_rgba(cr, colors.base.r, colors.base.g, colors.base.b,
+                        colors.base.a);
+  cairo_arc(cr, state.width / 2, state.height / 2, state.width / 2, 0,
+            2 * M_PI);
+  cairo_fill(cr);
 
+  /* Draw the border */
+  cairo_set_line_width(cr, state.border);
+  cairo_set_source_rgba(cr, colors.line.r, colors.line.g, colors.line.b,
+                        colors.line.a);
   // This renders great on my screen (110 dpi 1376x768 lcd screen)
   // How this would appear on a Hi-DPI screen is questionable
   double r = state.width / 2 - 0.5 * state.border;
   cairo_arc(cr, state.width / 2, state.height / 2, r, 0, 2 * M_PI);
   cairo_stroke(cr);
 
+  /* Draw the icon */
+  cairo_set_source_rgba(cr, colors.line.r, colors.line.g, colors.line.b,
+                        colors.line.a / 2);
   cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
   switch (button) {
   case BUTTON_CLOSE:
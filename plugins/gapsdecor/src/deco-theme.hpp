@@ -1,11 +1,30 @@
 #pragma once
 #include <wayfire/render-manager.hpp>
 #include "deco-button.hpp"
+#include "deco-text.hpp"
 
 namespace wf
 {
 namespace decor
 {
+/**
+ * The values of the gapsdecor/ options a theme is made of. Themes never
+ * read the options themselves: theme_registry_t hands them a snapshot each
+ * time the options change, so that all decorations switch at the same time.
+ */
+struct theme_options_t
+{
+    std::string font;
+    int title_height;
+    int border_size;
+    wf::color_t active_color;
+    wf::color_t inactive_color;
+    bool resize_stable_title;
+    bool shader_buttons;
+    bool composite_titlebar;
+    std::string button_order;
+};
+
 /**
  * A  class which manages the outlook of gapsdecors.
  * It is responsible for determining the background colors, sizes, etc.
@@ -13,13 +32,24 @@ namespace decor
 class gapsdecor_theme_t
 {
   public:
-    /** Create a new theme with the default parameters */
-    gapsdecor_theme_t();
+    /** Create a new theme with the given parameters */
+    gapsdecor_theme_t(const theme_options_t& options);
+
+    /** Replace the parameters, for ex. after the options changed */
+    void set_options(const theme_options_t& options);
 
     /** @return The available height for displaying the title */
     int get_title_height() const;
     /** @return The available border for resizing */
     int get_border_size() const;
+    /** @return The font used for the title */
+    std::string get_font() const;
+    /** @return The color used for the title text */
+    wf::color_t get_title_color() const;
+    /** @return Whether titles are rasterized independently of their width */
+    bool has_resize_stable_title() const;
+    /** @return The names of the buttons, from left to right */
+    std::string get_button_order() const;
     /** Set the flags for buttons */
     void set_buttons(button_type_t flags);
     button_type_t button_flags;
@@ -35,12 +65,31 @@ class gapsdecor_theme_t
     void render_background(const wf::render_target_t& fb, wf::geometry_t rectangle,
         const wf::geometry_t& scissor, bool active) const;
 
+    /** @return The background color for an active or inactive view */
+    wf::color_t get_background_color(bool active) const;
+
+    /**
+     * @return Whether the background fully hides what is behind it, so that
+     *   the decoration can be reported as opaque.
+     */
+    bool is_background_opaque(bool active) const;
+
     /**
      * Render the given text on a cairo_surface_t with the given size.
      * The caller is responsible for freeing the memory afterwards.
      */
     cairo_surface_t *render_text(std::string text, int width, int height) const;
 
+    /** Width argument for render_text() to size the surface to the text */
+    static constexpr int TITLE_NATURAL_WIDTH = text_renderer_t::NATURAL_WIDTH;
+
+    /**
+     * Same as render_text(), but with the font and color given explicitly.
+     * Does not access any options, so it is safe to call from any thread.
+     */
+    static cairo_surface_t *render_text(const std::string& text,
+        const std::string& font, wf::color_t color, int width, int height);
+
     struct button_state_t
     {
         /** Button width */
@@ -64,12 +113,27 @@ class gapsdecor_theme_t
     cairo_surface_t *get_button_surface(button_type_t button,
         const button_state_t& state) const;
 
+    /** @return The background color of a hovered or pressed button */
+    static wf::color_t get_button_hover_color(button_type_t button);
+
+    /**
+     * @return The colors of @button at the given hover progress, as drawn by
+     *   get_button_surface() and by the button shader.
+     */
+    static button_colors_t get_button_colors(button_type_t button,
+        double hover_progress);
+
+    /** @return Whether buttons are drawn with shaders instead of cairo */
+    bool has_shader_buttons() const;
+
+    /** @return Whether the titlebar is pre-composited into a single texture */
+    bool has_composited_titlebar() const;
+
+    /** @return The width of button outlines, relative to the button size */
+    double get_button_stroke() const;
+
   private:
-    wf::option_wrapper_t<std::string> font{"gapsdecor/font"};
-    wf::option_wrapper_t<int> title_height{"gapsdecor/title_height"};
-    wf::option_wrapper_t<int> border_size{"gapsdecor/border_size"};
-    wf::option_wrapper_t<wf::color_t> active_color{"gapsdecor/active_color"};
-    wf::option_wrapper_t<wf::color_t> inactive_color{"gapsdecor/inactive_color"};
+    theme_options_t options;
 };
 }
 }
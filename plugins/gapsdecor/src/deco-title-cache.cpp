@@ -0,0 +1,165 @@
+#include "deco-title-cache.hpp"
+#include "deco-stats.hpp"
+#include "deco-texture.hpp"
+#include "deco-theme.hpp"
+#include <algorithm>
+#include <wayfire/opengl.hpp>
+
+namespace wf {
+namespace decor {
+bool title_key_t::operator==(const title_key_t &other) const {
+  return text == other.text && font == other.font && width == other.width &&
+         height == other.height && scale == other.scale &&
+         color == other.color;
+}
+
+static void hash_combine(size_t &seed, size_t value) {
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+size_t title_key_hash_t::operator()(const title_key_t &key) const {
+  size_t seed = std::hash<std::string>{}(key.text);
+  hash_combine(seed, std::hash<std::string>{}(key.font));
+  hash_combine(seed, std::hash<int>{}(key.width));
+  hash_combine(seed, std::hash<int>{}(key.height));
+  hash_combine(seed, std::hash<double>{}(key.scale));
+  hash_combine(seed, std::hash<double>{}(key.color.r));
+  hash_combine(seed, std::hash<double>{}(key.color.g));
+  hash_combine(seed, std::hash<double>{}(key.color.b));
+  hash_combine(seed, std::hash<double>{}(key.color.a));
+  return seed;
+}
+
+title_cache_t::texture_ptr title_cache_t::acquire(const title_key_t &key,
+                                                  ready_callback_t ready,
+                                                  bool *rasterizing) {
+  if (rasterizing) {
+    *rasterizing = false;
+  }
+
+  auto it = entries.find(key);
+  if (it != entries.end()) {
+    /* Move to the front of the LRU list */
+    lru.splice(lru.begin(), lru, it->second.lru_pos);
+    ++stats.hits;
+    return it->second.texture;
+  }
+
+  auto pending = in_flight.find(key);
+  if (pending != in_flight.end()) {
+    /* Somebody else already asked for the same title */
+    ++stats.hits;
+    pending->second.push_back(std::move(ready));
+    return nullptr;
+  }
+
+  ++stats.misses;
+  ++global_stats().totals.title_rasterizations;
+  if (rasterizing) {
+    *rasterizing = true;
+  }
+
+  in_flight[key].push_back(std::move(ready));
+  raster_pool.submit(
+      [key]() {
+        return gapsdecor_theme_t::render_text(key.text, key.font, key.color,
+                                              key.width, key.height);
+      },
+      [this, key](cairo_surface_t *surface) {
+        handle_rasterized(key, surface);
+      });
+
+  return nullptr;
+}
+
+void title_cache_t::handle_rasterized(const title_key_t &key,
+                                      cairo_surface_t *surface) {
+  auto texture = take_texture(cairo_image_surface_get_width(surface),
+                              cairo_image_surface_get_height(surface));
+  OpenGL::render_begin();
+  texture->bytes = upload_surface_to_texture(surface, texture->tex);
+  OpenGL::render_end();
+  cairo_surface_destroy(surface);
+
+  lru.push_front(key);
+  entries[key] = entry_t{texture, lru.begin()};
+  stats.bytes += texture->bytes;
+
+  auto waiting = std::move(in_flight[key]);
+  in_flight.erase(key);
+  for (auto &ready : waiting) {
+    ready(texture);
+  }
+
+  /* Evict only after the waiters had a chance to pick up the new texture */
+  evict();
+}
+
+void title_cache_t::evict() {
+  const size_t limit = (size_t)std::max(0, (int)cache_size) * 1024;
+
+  /* Walk from the least recently used end, skipping titles still on
+   * screen: dropping them would not free anything. */
+  auto it = lru.end();
+  while (stats.bytes > limit && it != lru.begin()) {
+    --it;
+    auto entry = entries.find(*it);
+    if (entry->second.texture.use_count() > 1) {
+      continue;
+    }
+
+    stats.bytes -= entry->second.texture->bytes;
+    ++stats.evictions;
+    entries.erase(entry);
+    it = lru.erase(it);
+  }
+}
+
+void title_cache_t::release(const title_key_t &key, texture_ptr &texture) {
+  auto it = entries.find(key);
+  const bool ours = (it != entries.end()) && (it->second.texture == texture);
+  texture.reset();
+  if (!ours || (it->second.texture.use_count() > 1)) {
+    return;
+  }
+
+  /* simple_texture_t::release() makes the GL context current by itself */
+  stats.bytes -= it->second.texture->bytes;
+  it->second.texture->tex.release();
+  lru.erase(it->second.lru_pos);
+  entries.erase(it);
+}
+
+std::shared_ptr<title_texture_t> title_cache_t::take_texture(int width,
+                                                             int height) {
+  const size_t limit = (size_t)std::max(0, (int)cache_size) * 1024;
+  if (stats.bytes + size_t(width) * height * 4 <= limit) {
+    return std::make_shared<title_texture_t>();
+  }
+
+  for (auto it = lru.rbegin(); it != lru.rend(); ++it) {
+    auto entry = entries.find(*it);
+    auto &tex = entry->second.texture->tex;
+    if ((entry->second.texture.use_count() > 1) || (tex.width != width) ||
+        (tex.height != height)) {
+      continue;
+    }
+
+    auto texture = std::move(entry->second.texture);
+    stats.bytes -= texture->bytes;
+    ++stats.evictions;
+    entries.erase(entry);
+    lru.erase(std::prev(it.base()));
+    return texture;
+  }
+
+  return std::make_shared<title_texture_t>();
+}
+
+title_cache_stats_t title_cache_t::get_stats() const {
+  auto result = stats;
+  result.entries = entries.size();
+  return result;
+}
+} // namespace decor
+} // namespace wf
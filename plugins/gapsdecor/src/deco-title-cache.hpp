@@ -0,0 +1,136 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "deco-raster-pool.hpp"
+#include <cairo.h>
+#include <wayfire/config/types.hpp>
+#include <wayfire/plugins/common/simple-texture.hpp>
+#include <wayfire/option-wrapper.hpp>
+
+namespace wf {
+namespace decor {
+/**
+ * Everything which influences the rasterized title bitmap.
+ * Two views whose titles map to equal keys can share the same texture.
+ */
+struct title_key_t {
+  std::string text;
+  std::string font;
+  /* Size of the bitmap in pixels */
+  int width;
+  int height;
+  double scale;
+  wf::color_t color;
+
+  bool operator==(const title_key_t &other) const;
+  bool operator!=(const title_key_t &other) const { return !(*this == other); }
+};
+
+struct title_key_hash_t {
+  size_t operator()(const title_key_t &key) const;
+};
+
+/**
+ * A rasterized title, uploaded to the GPU.
+ * Instances are shared between all views displaying the same title.
+ */
+struct title_texture_t {
+  wf::simple_texture_t tex;
+  /* Size of the texture in GPU memory */
+  size_t bytes = 0;
+};
+
+struct title_cache_stats_t {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  /* Number and size of the entries currently in the cache */
+  size_t entries = 0;
+  size_t bytes = 0;
+};
+
+/**
+ * A process-wide cache of title textures, shared by all gapsdecor nodes via
+ * wf::shared_data::ref_ptr_t.
+ *
+ * Entries are reference-counted: a texture stays alive as long as a view
+ * displays it. Unused entries are kept around in LRU order until the cache
+ * grows past gapsdecor/title_cache_size.
+ *
+ * Missing titles are rasterized on a worker pool and uploaded from the main
+ * loop once ready, never from within a render pass.
+ */
+class title_cache_t {
+public:
+  using texture_ptr = std::shared_ptr<const title_texture_t>;
+  /** Called on the main thread once a requested title has been uploaded */
+  using ready_callback_t = std::function<void(texture_ptr)>;
+
+  /**
+   * Find the texture for the given key.
+   *
+   * On a miss, the title is queued for rasterization and nullptr is returned.
+   * @ready is called once the texture is available. Concurrent requests for
+   * the same key share a single rasterization.
+   *
+   * @param rasterizing If not null, set to whether this call started a new
+   *   rasterization.
+   */
+  texture_ptr acquire(const title_key_t &key, ready_callback_t ready,
+                      bool *rasterizing = nullptr);
+
+  /**
+   * Give up a texture returned by acquire(), resetting @texture. If nobody
+   * else displays the title, its texture is freed right away instead of
+   * waiting in the cache for reuse.
+   *
+   * Must not be called between OpenGL::render_begin() and
+   * OpenGL::render_end().
+   */
+  void release(const title_key_t &key, texture_ptr &texture);
+
+  /** @return The hit/miss counters and current memory usage */
+  title_cache_stats_t get_stats() const;
+
+private:
+  struct entry_t {
+    std::shared_ptr<title_texture_t> texture;
+    std::list<title_key_t>::iterator lru_pos;
+  };
+
+  std::unordered_map<title_key_t, entry_t, title_key_hash_t> entries;
+  /* Most recently used keys are in front */
+  std::list<title_key_t> lru;
+  /* Titles being rasterized, with everyone waiting for them */
+  std::unordered_map<title_key_t, std::vector<ready_callback_t>,
+                     title_key_hash_t>
+      in_flight;
+  title_cache_stats_t stats;
+
+  wf::option_wrapper_t<int> cache_size{"gapsdecor/title_cache_size"};
+
+  /**
+   * @return A texture for a new title of the given size. If the title would
+   *   not fit in the size limit, the texture of an unused title of the same
+   *   size is taken over, so that its storage does not have to be
+   *   reallocated. Otherwise, a new empty texture.
+   */
+  std::shared_ptr<title_texture_t> take_texture(int width, int height);
+
+  /** Upload a finished title and notify everyone waiting for it */
+  void handle_rasterized(const title_key_t &key, cairo_surface_t *surface);
+  /** Drop unused entries until the cache fits in its size limit */
+  void evict();
+
+  /* Declared last, so that workers are stopped before anything else is
+   * destroyed */
+  raster_pool_t raster_pool;
+};
+} // namespace decor
+} // namespace wf
@@ -1,21 +1,155 @@
+#include <chrono>
+#include <map>
+#include <memory>
+#include <vector>
 #include <wayfire/matcher.hpp>
+#include <wayfire/output-layout.hpp>
 #include <wayfire/output.hpp>
 #include <wayfire/per-output-plugin.hpp>
+#include <wayfire/plugins/common/shared-core-data.hpp>
+#include <wayfire/plugins/ipc/ipc-helpers.hpp>
+#include <wayfire/plugins/ipc/ipc-method-repository.hpp>
+#include <wayfire/render-manager.hpp>
 #include <wayfire/signal-definitions.hpp>
 #include <wayfire/txn/transaction-manager.hpp>
+#include <wayfire/util/log.hpp>
 #include <wayfire/view.hpp>
 #include <wayfire/workarea.hpp>
 #include <wayfire/workspace-set.hpp>
 
+#include "deco-button-atlas.hpp"
+#include "deco-match-cache.hpp"
+#include "deco-stats.hpp"
 #include "deco-subsurface.hpp"
+#include "deco-theme-registry.hpp"
+#include "deco-title-cache.hpp"
 #include "wayfire/core.hpp"
 #include "wayfire/plugin.hpp"
 #include "wayfire/signal-provider.hpp"
 #include "wayfire/toplevel-view.hpp"
 #include "wayfire/toplevel.hpp"
 
-class wayfire_gapsdecor : public wf::plugin_interface_t {
-  wf::view_matcher_t ignore_views{"gapsdecor/ignore_views"};
+/**
+ * Measures how long the scene of an output takes to render, per frame, and
+ * how long views mapped on the output take to appear.
+ */
+struct frame_timer_t {
+  std::chrono::steady_clock::time_point start;
+  /* When the views mapped since the last frame were mapped */
+  std::vector<std::chrono::steady_clock::time_point> pending_maps;
+
+  wf::effect_hook_t on_frame_start = [=]() {
+    start = std::chrono::steady_clock::now();
+  };
+  wf::effect_hook_t on_frame_end = [=]() {
+    auto &stats = wf::decor::global_stats();
+    auto now = std::chrono::steady_clock::now();
+    stats.frame.record(now - start);
+    for (auto mapped : pending_maps) {
+      stats.map_to_first_frame.record(now - mapped);
+    }
+
+    pending_maps.clear();
+  };
+};
+
+class wayfire_gapsdecor : public wf::plugin_interface_t,
+                          public wf::per_output_tracker_mixin_t<> {
+  wf::decor::match_cache_t ignore_views;
+  wf::shared_data::ref_ptr_t<wf::ipc::method_repository_t> ipc_repo;
+  wf::shared_data::ref_ptr_t<wf::decor::title_cache_t> title_cache;
+  wf::shared_data::ref_ptr_t<wf::decor::button_atlas_t> button_atlas;
+  wf::shared_data::ref_ptr_t<wf::decor::theme_registry_t> themes;
+
+  static nlohmann::json
+  counters_to_json(const wf::decor::decoration_counters_t &counters) {
+    nlohmann::json result;
+    result["title_rasterizations"] = counters.title_rasterizations;
+    result["texture_uploads"] = counters.texture_uploads;
+    result["bytes_uploaded"] = counters.bytes_uploaded;
+    return result;
+  }
+
+  static nlohmann::json timing_to_json(const wf::decor::timing_t &timing) {
+    auto summary = timing.summarize();
+    nlohmann::json result;
+    result["count"] = summary.count;
+    result["total_ms"] = summary.total_ms;
+    result["p99_ms"] = summary.p99_ms;
+    return result;
+  }
+
+  /* Counters, timings and GPU memory of all decorations */
+  wf::ipc::method_callback ipc_stats = [=](nlohmann::json) {
+    auto &stats = wf::decor::global_stats();
+    auto response = wf::ipc::json_ok();
+    response["totals"] = counters_to_json(stats.totals);
+    response["totals"]["button_rasterizations"] = stats.button_rasterizations;
+    response["totals"]["titles_coalesced"] = stats.titles_coalesced;
+    response["totals"]["decorations_released"] = stats.decorations_released;
+    response["totals"]["decorations_rethemed"] = stats.decorations_rethemed;
+    response["totals"]["transactions_scheduled"] = stats.transactions_scheduled;
+    response["totals"]["transactions_skipped"] = stats.transactions_skipped;
+    response["themes"]["generation"] = themes->get_generation();
+    response["themes"]["instances"] = themes->get_theme_count();
+
+    response["timings"]["render_text"] = timing_to_json(stats.render_text);
+    response["timings"]["get_button_surface"] =
+        timing_to_json(stats.get_button_surface);
+    response["timings"]["render_scissor_box"] =
+        timing_to_json(stats.render_scissor_box);
+    response["timings"]["frame"] = timing_to_json(stats.frame);
+    response["timings"]["load"] = timing_to_json(stats.load);
+    response["timings"]["map_to_first_frame"] =
+        timing_to_json(stats.map_to_first_frame);
+    response["totals"]["first_frames"] = stats.first_frames;
+    response["totals"]["first_frames_without_title"] =
+        stats.first_frames_without_title;
+
+    auto cache = title_cache->get_stats();
+    response["title_cache"]["hits"] = cache.hits;
+    response["title_cache"]["misses"] = cache.misses;
+    response["title_cache"]["evictions"] = cache.evictions;
+    response["title_cache"]["entries"] = cache.entries;
+
+    auto matches = ignore_views.get_stats();
+    auto lookups = matches.hits + matches.misses;
+    response["ignore_views"]["hits"] = matches.hits;
+    response["ignore_views"]["misses"] = matches.misses;
+    response["ignore_views"]["invalidations"] = matches.invalidations;
+    response["ignore_views"]["hit_rate"] =
+        lookups ? double(matches.hits) / lookups : 0.0;
+
+    size_t titlebar_bytes = 0;
+    response["views"] = nlohmann::json::array();
+    for (auto view : wf::get_core().get_all_views()) {
+      auto toplevel = wf::toplevel_cast(view);
+      auto deco = toplevel
+                      ? toplevel->toplevel()->get_data<wf::simple_decorator_t>()
+                      : nullptr;
+      if (!deco) {
+        continue;
+      }
+
+      auto view_stats = deco->get_stats();
+      auto entry = counters_to_json(view_stats.counters);
+      entry["id"] = view->get_id();
+      entry["title_bytes"] = view_stats.title_bytes;
+      entry["titlebar_bytes"] = view_stats.titlebar_bytes;
+      response["views"].push_back(entry);
+      titlebar_bytes += view_stats.titlebar_bytes;
+    }
+
+    /* Titles are counted once here, even when shared between views */
+    auto &memory = response["memory"];
+    memory["title_cache"] = cache.bytes;
+    memory["button_atlas"] = button_atlas->get_memory_usage();
+    memory["titlebars"] = titlebar_bytes;
+    memory["total"] =
+        cache.bytes + button_atlas->get_memory_usage() + titlebar_bytes;
+
+    return response;
+  };
 
   wf::signal::connection_t<wf::txn::new_transaction_signal> on_new_tx =
       [=](wf::txn::new_transaction_signal *ev) {
@@ -60,34 +194,180 @@ class wayfire_gapsdecor : public wf::plugin_interface_t {
   wf::signal::connection_t<wf::view_tiled_signal> on_view_tiled =
       [=](wf::view_tiled_signal *ev) { update_view_gapsdecor(ev->view); };
 
+  // decorations keep a title texture per output scale, drop unused ones
+  wf::signal::connection_t<wf::output_layout_configuration_changed_signal>
+      on_output_config_changed =
+          [=](wf::output_layout_configuration_changed_signal *ev) {
+            prune_title_scales();
+          };
+
+  // lay out all decorations again once theme options changed
+  wf::signal::connection_t<wf::decor::theme_changed_signal> on_theme_changed =
+      [=](wf::decor::theme_changed_signal *ev) { apply_theme(); };
+
+  std::map<wf::output_t *, std::unique_ptr<frame_timer_t>> frame_timers;
+
+  // measured for all toplevels, so that the latency with and without
+  // decorations can be compared
+  wf::signal::connection_t<wf::view_mapped_signal> on_view_mapped =
+      [=](wf::view_mapped_signal *ev) {
+        auto it = frame_timers.find(ev->view->get_output());
+        if (wf::toplevel_cast(ev->view) && (it != frame_timers.end())) {
+          it->second->pending_maps.push_back(std::chrono::steady_clock::now());
+        }
+      };
+
+  void handle_new_output(wf::output_t *output) override {
+    auto &timer = frame_timers[output];
+    timer = std::make_unique<frame_timer_t>();
+    output->render->add_effect(&timer->on_frame_start, wf::OUTPUT_EFFECT_PRE);
+    output->render->add_effect(&timer->on_frame_end,
+                               wf::OUTPUT_EFFECT_OVERLAY);
+  }
+
+  void handle_output_removed(wf::output_t *output) override {
+    auto it = frame_timers.find(output);
+    if (it != frame_timers.end()) {
+      output->render->rem_effect(&it->second->on_frame_start);
+      output->render->rem_effect(&it->second->on_frame_end);
+      frame_timers.erase(it);
+    }
+
+    prune_title_scales(output);
+  }
+
 public:
   void init() override {
     wf::get_core().connect(&on_gapsdecor_state_changed);
     wf::get_core().tx_manager->connect(&on_new_tx);
     wf::get_core().connect(&on_view_tiled);
+    wf::get_core().connect(&on_view_mapped);
+    wf::get_core().output_layout->connect(&on_output_config_changed);
+    themes->connect(&on_theme_changed);
+    ipc_repo->register_method("gapsdecor/stats", ipc_stats);
+    this->init_output_tracking();
 
-    for (auto &view : wf::get_core().get_all_views()) {
-      update_view_gapsdecor(view);
+    /* All views are decorated in a single transaction */
+    auto start = std::chrono::steady_clock::now();
+    auto tx = wf::txn::transaction_t::create();
+    auto views = wf::get_core().get_all_views();
+    for (auto &view : views) {
+      update_view_gapsdecor(view, tx.get());
     }
+
+    schedule_batch(std::move(tx));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    wf::decor::global_stats().load.record(elapsed);
+    LOGI("gapsdecor: loaded with ", views.size(), " views in ",
+         std::chrono::duration<double, std::milli>(elapsed).count(), " ms");
   }
 
   void fini() override {
+    ipc_repo->unregister_method("gapsdecor/stats");
+    this->fini_output_tracking();
+    for (auto &[output, timer] : frame_timers) {
+      output->render->rem_effect(&timer->on_frame_start);
+      output->render->rem_effect(&timer->on_frame_end);
+    }
+
+    frame_timers.clear();
+
+    /* All decorations are removed in a single transaction */
+    auto start = std::chrono::steady_clock::now();
+    auto tx = wf::txn::transaction_t::create();
+    auto views = wf::get_core().get_all_views();
+    for (auto view : views) {
+      auto toplevel = wf::toplevel_cast(view);
+      if (toplevel &&
+          toplevel->toplevel()->get_data<wf::simple_decorator_t>()) {
+        remove_gapsdecor(toplevel);
+        tx->add_object(toplevel->toplevel());
+      }
+    }
+
+    schedule_batch(std::move(tx));
+    ignore_views.clear();
+    LOGI("gapsdecor: unloaded with ", views.size(), " views in ",
+         std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+             .count(),
+         " ms");
+  }
+
+  /** Schedule @tx, unless it is empty */
+  void schedule_batch(wf::txn::transaction_uptr tx) {
+    if (!tx->get_objects().empty()) {
+      wf::get_core().tx_manager->schedule_transaction(std::move(tx));
+      ++wf::decor::global_stats().transactions_scheduled;
+    }
+  }
+
+  /**
+   * Release the title textures of all decorations for scales which no output
+   * uses anymore.
+   *
+   * @param removed An output which is being removed, and whose scale should
+   *   not be counted.
+   */
+  void prune_title_scales(wf::output_t *removed = nullptr) {
+    std::set<double> scales;
+    for (auto output : wf::get_core().output_layout->get_outputs()) {
+      if (output != removed) {
+        scales.insert(output->handle->scale);
+      }
+    }
+
     for (auto view : wf::get_core().get_all_views()) {
       if (auto toplevel = wf::toplevel_cast(view)) {
-        remove_gapsdecor(toplevel);
-        wf::get_core().tx_manager->schedule_object(toplevel->toplevel());
+        if (auto deco =
+                toplevel->toplevel()->get_data<wf::simple_decorator_t>()) {
+          deco->prune_title_scales(scales);
+        }
+      }
+    }
+  }
+
+  /**
+   * Bring all decorations up to date with the theme, and update the margins
+   * of the views whose decoration changed size in a single transaction.
+   * Decorations which only look different are just redrawn.
+   */
+  void apply_theme() {
+    auto tx = wf::txn::transaction_t::create();
+    for (auto view : wf::get_core().get_all_views()) {
+      auto toplevel = wf::toplevel_cast(view);
+      auto deco = toplevel
+                      ? toplevel->toplevel()->get_data<wf::simple_decorator_t>()
+                      : nullptr;
+      if (!deco || !deco->update_theme()) {
+        continue;
+      }
+
+      /* Keep the size of the client, the decoration grows or shrinks */
+      auto &pending = toplevel->toplevel()->pending();
+      auto margins = deco->get_margins(pending);
+      if (!pending.fullscreen && !pending.tiled_edges) {
+        pending.geometry = wf::expand_geometry_by_margins(
+            wf::shrink_geometry_by_margins(pending.geometry, pending.margins),
+            margins);
       }
+
+      pending.margins = margins;
+      tx->add_object(toplevel->toplevel());
     }
+
+    schedule_batch(std::move(tx));
   }
 
   /**
    * Uses view_matcher_t to match whether the given view needs to be
-   * ignored for gapsdecor
+   * ignored for gapsdecor. The result is cached until the view properties
+   * the criteria refer to change.
    *
    * @param view The view to match
    * @return Whether the given view should be decorated?
    */
-  bool ignore_gapsdecor_of_view(wayfire_view view) {
+  bool ignore_gapsdecor_of_view(wayfire_toplevel_view view) {
     return ignore_views.matches(view);
   }
 
@@ -124,15 +404,58 @@ public:
     pending.margins = {0, 0, 0, 0};
   }
 
-  void update_view_gapsdecor(wayfire_view view) {
+  static bool same_margins(const wf::decoration_margins_t &a,
+                           const wf::decoration_margins_t &b) {
+    return (a.left == b.left) && (a.right == b.right) && (a.top == b.top) &&
+           (a.bottom == b.bottom);
+  }
+
+  /**
+   * @return Whether the view is decorated as it should be, with the right
+   *   margins, so that updating it would change nothing
+   */
+  bool is_gapsdecor_up_to_date(wayfire_toplevel_view view, bool decorate) {
+    auto deco = view->toplevel()->get_data<wf::simple_decorator_t>();
+    if (decorate != (deco != nullptr)) {
+      return false;
+    }
+
+    const auto &pending = view->toplevel()->pending();
+    wf::decoration_margins_t margins{0, 0, 0, 0};
+    if (deco) {
+      margins = deco->get_margins(pending);
+    }
+
+    return same_margins(pending.margins, margins);
+  }
+
+  /**
+   * Decorate @view or remove its decoration, as needed.
+   *
+   * @param tx The transaction to add the view to, if any. Otherwise, the
+   *   view is scheduled in a transaction of its own.
+   */
+  void update_view_gapsdecor(wayfire_view view,
+                             wf::txn::transaction_t *tx = nullptr) {
     if (auto toplevel = wf::toplevel_cast(view)) {
-      if (should_decorate_view(toplevel)) {
+      const bool decorate = should_decorate_view(toplevel);
+      if (is_gapsdecor_up_to_date(toplevel, decorate)) {
+        ++wf::decor::global_stats().transactions_skipped;
+        return;
+      }
+
+      if (decorate) {
         adjust_new_gapsdecors(toplevel);
       } else {
         remove_gapsdecor(toplevel);
       }
 
-      wf::get_core().tx_manager->schedule_object(toplevel->toplevel());
+      if (tx) {
+        tx->add_object(toplevel->toplevel());
+      } else {
+        wf::get_core().tx_manager->schedule_object(toplevel->toplevel());
+        ++wf::decor::global_stats().transactions_scheduled;
+      }
     }
   }
 };